@@ -0,0 +1,594 @@
+#include "benchmarks.h"
+#include <array>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <utility>
+
+using namespace seecs::components;
+
+// Fastest of runs calls to func, in nanoseconds per item
+template <typename Func>
+static double BestNsPerItem(size_t items, int runs, Func&& func)
+{
+    using Clock = std::chrono::steady_clock;
+
+    double best = 0.0;
+    for (int run = 0; run < runs; run++)
+    {
+        Clock::time_point start = Clock::now();
+        func();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count()/(double)std::max<size_t>(items, 1);
+        if ((run == 0) || (ns < best)) best = ns;
+    }
+    return best;
+}
+
+// ForEach() against Each() over views of one, two and three components.
+// Every entity has all three, so each view visits the whole world.
+static nlohmann::ordered_json BenchmarkEach()
+{
+    constexpr size_t ENTITIES = 1000000;
+    constexpr int RUNS = 5;
+
+    seecs::ECS ecs;
+    ecs.CreateEntities(ENTITIES, Transform{}, Motion{ {1.0f, 0.5f}, {0.0f, 0.0f} }, Boid{});
+
+    auto one = [](Transform& t) { t.rotation += 1.0f; };
+    auto two = [](Transform& t, Motion& m)
+    {
+        t.position.x += m.velocity.x*0.01f;
+        t.position.y += m.velocity.y*0.01f;
+    };
+    auto three = [](Transform& t, Motion& m, Boid& b)
+    {
+        m.velocity.x = std::min(m.velocity.x + m.acceleration.x, b.maxSpeed);
+        t.position.x += m.velocity.x*0.01f;
+    };
+
+    nlohmann::ordered_json nsPerEntity = {
+        {"1", {
+            {"for_each", BestNsPerItem(ENTITIES, RUNS, [&] { ecs.View<Transform>().ForEach(one); })},
+            {"each", BestNsPerItem(ENTITIES, RUNS, [&] { ecs.View<Transform>().Each(one); })}
+        }},
+        {"2", {
+            {"for_each", BestNsPerItem(ENTITIES, RUNS, [&] { ecs.View<Transform, Motion>().ForEach(two); })},
+            {"each", BestNsPerItem(ENTITIES, RUNS, [&] { ecs.View<Transform, Motion>().Each(two); })}
+        }},
+        {"3", {
+            {"for_each", BestNsPerItem(ENTITIES, RUNS, [&] { ecs.View<Transform, Motion, Boid>().ForEach(three); })},
+            {"each", BestNsPerItem(ENTITIES, RUNS, [&] { ecs.View<Transform, Motion, Boid>().Each(three); })}
+        }}
+    };
+
+    return {
+        {"entities", ENTITIES},
+        {"runs", RUNS},
+        {"ns_per_entity", nsPerEntity}
+    };
+}
+
+// Per-entity structural changes in one storage mode, fastest of runs in ns per entity.
+// Each run starts from an empty world, so the migrations always hit the same state.
+static nlohmann::ordered_json MeasureMigrations(seecs::StorageMode mode, size_t entities, int runs)
+{
+    using Clock = std::chrono::steady_clock;
+    auto nsPerEntity = [entities](Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count()/(double)entities;
+    };
+
+    double create = std::numeric_limits<double>::max(), add = create, each = create, remove = create;
+    for (int run = 0; run < runs; run++)
+    {
+        seecs::ECS ecs(mode);
+        std::vector<seecs::EntityID> ids(entities);
+
+        Clock::time_point start = Clock::now();
+        for (seecs::EntityID& id : ids)
+        {
+            id = ecs.CreateEntity();
+            ecs.Add<Transform>(id, {});
+            ecs.Add<Motion>(id, { {1.0f, 0.5f}, {0.0f, 0.0f} });
+        }
+        create = std::min(create, nsPerEntity(start));
+
+        start = Clock::now();
+        for (seecs::EntityID id : ids) ecs.Add<Boid>(id, {});
+        add = std::min(add, nsPerEntity(start));
+
+        start = Clock::now();
+        ecs.View<Transform, Motion, Boid>().Each([](Transform& t, Motion& m, Boid& b)
+        {
+            m.velocity.x = std::min(m.velocity.x + m.acceleration.x, b.maxSpeed);
+            t.position.x += m.velocity.x*0.01f;
+        });
+        each = std::min(each, nsPerEntity(start));
+
+        start = Clock::now();
+        for (seecs::EntityID id : ids) ecs.Remove<Boid>(id);
+        remove = std::min(remove, nsPerEntity(start));
+    }
+
+    return {
+        {"create_with_2", create},
+        {"add_3rd", add},
+        {"view3_each", each},
+        {"remove_3rd", remove}
+    };
+}
+
+// Sparse set against archetype storage: Add and Remove move every component
+// of the entity to another archetype, in exchange for contiguous iteration
+static nlohmann::ordered_json BenchmarkMigrate()
+{
+    constexpr size_t ENTITIES = 200000;
+    constexpr int RUNS = 5;
+
+    return {
+        {"entities", ENTITIES},
+        {"runs", RUNS},
+        {"ns_per_entity", {
+            {"sparse_set", MeasureMigrations(seecs::StorageMode::SparseSet, ENTITIES, RUNS)},
+            {"archetype", MeasureMigrations(seecs::StorageMode::Archetype, ENTITIES, RUNS)}
+        }}
+    };
+}
+
+// Per-entity calls against CreateEntities() and DestroyEntities() for one
+// entity count, fastest of runs in ns per entity. Entities get a Transform,
+// a Motion and a Boid. Destroying every 4th entity is a batch big enough for
+// DestroyEntities() to compact the pools, destroying the rest is too.
+static nlohmann::ordered_json MeasureBulk(size_t entities, int runs)
+{
+    using Clock = std::chrono::steady_clock;
+    auto nsPerEntity = [](Clock::time_point start, size_t count)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count()/(double)count;
+    };
+
+    const Motion motion = { {1.0f, 0.5f}, {0.0f, 0.0f} };
+    double create = std::numeric_limits<double>::max(), bulkCreate = create;
+    double destroyQuarter = create, bulkDestroyQuarter = create, destroyRest = create, bulkDestroyRest = create;
+    for (int run = 0; run < runs; run++)
+    {
+        std::vector<seecs::EntityID> ids(entities), quarter, rest;
+
+        // Per-entity calls
+        {
+            seecs::ECS ecs;
+            Clock::time_point start = Clock::now();
+            for (seecs::EntityID& id : ids)
+            {
+                id = ecs.CreateEntity();
+                ecs.Add<Transform>(id, {});
+                ecs.Add<Motion>(id, Motion(motion));
+                ecs.Add<Boid>(id, {});
+            }
+            create = std::min(create, nsPerEntity(start, entities));
+
+            quarter.clear();
+            rest.clear();
+            for (size_t i = 0; i < entities; i++) ((i % 4 == 0)? quarter : rest).push_back(ids[i]);
+
+            start = Clock::now();
+            for (seecs::EntityID id : quarter) ecs.DeleteEntity(id);
+            destroyQuarter = std::min(destroyQuarter, nsPerEntity(start, quarter.size()));
+
+            start = Clock::now();
+            for (seecs::EntityID id : rest) ecs.DeleteEntity(id);
+            destroyRest = std::min(destroyRest, nsPerEntity(start, rest.size()));
+        }
+
+        // Bulk calls
+        {
+            seecs::ECS ecs;
+            Clock::time_point start = Clock::now();
+            std::span<const seecs::EntityID> created = ecs.CreateEntities(entities, Transform{}, motion, Boid{});
+            bulkCreate = std::min(bulkCreate, nsPerEntity(start, entities));
+
+            quarter.clear();
+            rest.clear();
+            for (size_t i = 0; i < created.size(); i++) ((i % 4 == 0)? quarter : rest).push_back(created[i]);
+
+            start = Clock::now();
+            ecs.DestroyEntities(quarter);
+            bulkDestroyQuarter = std::min(bulkDestroyQuarter, nsPerEntity(start, quarter.size()));
+
+            start = Clock::now();
+            ecs.DestroyEntities(rest);
+            bulkDestroyRest = std::min(bulkDestroyRest, nsPerEntity(start, rest.size()));
+        }
+    }
+
+    return {
+        {"create", {{"per_entity", create}, {"bulk", bulkCreate}}},
+        {"destroy_every_4th", {{"per_entity", destroyQuarter}, {"bulk", bulkDestroyQuarter}}},
+        {"destroy_rest", {{"per_entity", destroyRest}, {"bulk", bulkDestroyRest}}}
+    };
+}
+
+// CreateEntities() and DestroyEntities() against the per-entity calls at 100k and 1M entities
+static nlohmann::ordered_json BenchmarkBulk()
+{
+    constexpr int RUNS = 3;
+
+    return {
+        {"runs", RUNS},
+        {"ns_per_entity", {
+            {"100000", MeasureBulk(100000, RUNS)},
+            {"1000000", MeasureBulk(1000000, RUNS)}
+        }}
+    };
+}
+
+// Create/destroy churn at 1M entities with one component: create them all,
+// then rounds of deleting about 40% at random and recreating as many, which
+// reuses the freed slots with bumped versions, then destroy everything.
+// Every deleted handle must report not alive afterwards.
+static nlohmann::ordered_json BenchmarkChurn()
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t ENTITIES = 1000000;
+    constexpr int ROUNDS = 5;
+    constexpr int RUNS = 3;
+
+    auto ms = [](Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+
+    double create = std::numeric_limits<double>::max(), churn = create, destroy = create;
+    size_t churned = 0, staleAlive = 0;
+    for (int run = 0; run < RUNS; run++)
+    {
+        seecs::ECS ecs;
+        std::vector<seecs::EntityID> ids(ENTITIES), stale;
+        std::mt19937 rng(1);
+
+        Clock::time_point start = Clock::now();
+        for (seecs::EntityID& id : ids)
+        {
+            id = ecs.CreateEntity();
+            ecs.Add<Transform>(id, {});
+        }
+        create = std::min(create, ms(start));
+
+        churned = 0;
+        stale.clear();
+        start = Clock::now();
+        for (int round = 0; round < ROUNDS; round++)
+        {
+            size_t deleted = 0;
+            for (seecs::EntityID& id : ids)
+            {
+                if (rng() % 5 >= 2) continue;
+                stale.push_back(id);
+                ecs.DeleteEntity(id); // Nulls id, the slot is recreated below
+                deleted++;
+            }
+            for (seecs::EntityID& id : ids)
+            {
+                if (id != seecs::NULL_ENTITY) continue;
+                id = ecs.CreateEntity();
+                ecs.Add<Transform>(id, {});
+            }
+            churned += deleted;
+        }
+        churn = std::min(churn, ms(start));
+
+        staleAlive = 0;
+        for (seecs::EntityID id : stale) staleAlive += ecs.IsAlive(id);
+
+        start = Clock::now();
+        for (seecs::EntityID& id : ids) ecs.DeleteEntity(id);
+        destroy = std::min(destroy, ms(start));
+    }
+
+    return {
+        {"entities", ENTITIES},
+        {"rounds", ROUNDS},
+        {"runs", RUNS},
+        {"churned", churned},
+        {"stale_alive", staleAlive},
+        {"ms", {
+            {"create", create},
+            {"churn", churn},
+            {"destroy", destroy}
+        }},
+        {"ns_per_entity", {
+            {"create", create*1e6/ENTITIES},
+            {"churn_delete_and_create", churn*1e6/(double)std::max<size_t>(churned, 1)},
+            {"destroy", destroy*1e6/ENTITIES}
+        }}
+    };
+}
+
+// Collision events through the event bus at 100k per frame: publishing them,
+// then a ForEachThisFrame() consumer and a Reader consumer going over them.
+// ms_per_frame adds the three up, publishing as the systems do.
+// The queue holds a whole frame; the game's CollisionEvent queue holds 1 << 16,
+// so at this rate its readers would see only the newest 65536 per frame.
+// The old collision_system printed every pair with std::endl instead, timed
+// here into an ostringstream so the console speed doesn't count.
+static nlohmann::ordered_json BenchmarkEvents()
+{
+    using namespace seecs::events;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t EVENTS = 100000;
+    constexpr int FRAMES = 20;
+
+    auto nsPerEvent = [](Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count()/(double)EVENTS;
+    };
+
+    seecs::EventBus bus;
+    seecs::EventQueue<CollisionEvent>& queue = bus.Register<CollisionEvent>(EVENTS);
+    seecs::EventQueue<CollisionEvent>::Reader reader = queue.MakeReader();
+
+    double publish = std::numeric_limits<double>::max(), busPublish = publish, forEach = publish, read = publish;
+    size_t seen = 0;
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        // Like collision_system, look the queue up once per frame. Every other
+        // frame goes through EventBus::Publish(), which looks it up per event.
+        Clock::time_point start = Clock::now();
+        bus.BeginFrame();
+        for (size_t i = 0; i < EVENTS; i++)
+        {
+            CollisionEvent event;
+            event.first = seecs::MakeEntityID((seecs::EntityID)i, 0);
+            event.second = seecs::MakeEntityID((seecs::EntityID)i + 1, 0);
+            event.phase = (CollisionPhase)(i % 3);
+            event.isTrigger = (i % 7) == 0;
+            if (frame % 2) bus.Publish(event);
+            else queue.Publish(event);
+        }
+        double& published = (frame % 2)? busPublish : publish;
+        published = std::min(published, nsPerEvent(start));
+
+        start = Clock::now();
+        size_t triggers = 0;
+        queue.ForEachThisFrame([&triggers](const CollisionEvent& event) { triggers += event.isTrigger; });
+        forEach = std::min(forEach, nsPerEvent(start));
+
+        start = Clock::now();
+        size_t begins = 0;
+        queue.Read(reader, [&begins](const CollisionEvent& event) { begins += (event.phase == CollisionPhase::Begin); });
+        read = std::min(read, nsPerEvent(start));
+
+        seen += triggers + begins; // Reported, so the consumers aren't optimized out
+    }
+
+    double endl = std::numeric_limits<double>::max();
+    for (int frame = 0; frame < 3; frame++)
+    {
+        std::ostringstream out;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < EVENTS; i++) out << "Collision between " << i << " and " << i + 1 << std::endl;
+        endl = std::min(endl, nsPerEvent(start));
+    }
+
+    return {
+        {"events_per_frame", EVENTS},
+        {"frames", FRAMES},
+        {"capacity", queue.GetCapacity()},
+        {"dropped", reader.dropped},
+        {"consumed", seen},
+        {"ns_per_event", {
+            {"publish", publish},
+            {"bus_publish", busPublish},
+            {"for_each_this_frame", forEach},
+            {"reader", read},
+            {"ostream_endl", endl}
+        }},
+        {"ms_per_frame", (publish + forEach + read)*EVENTS/1e6}
+    };
+}
+
+// Filler component types for the registry benchmark, one per possible slot
+template <size_t N>
+struct SlotComponent
+{
+    float value = 1.0f;
+};
+
+using AddSlotFunc = void (*)(seecs::ECS&, seecs::EntityID);
+
+template <size_t... Slots>
+static void RegisterSlotComponents(seecs::ECS& ecs, std::index_sequence<Slots...>)
+{
+    ecs.RegisterPools<SlotComponent<Slots>...>();
+}
+
+template <size_t... Slots>
+static std::array<AddSlotFunc, sizeof...(Slots)> MakeSlotAdders(std::index_sequence<Slots...>)
+{
+    return { +[](seecs::ECS& ecs, seecs::EntityID id) { ecs.Add<SlotComponent<Slots>>(id, {}); }... };
+}
+
+// Has(), Get() and filtered views in a world that registers as many component
+// types as it can hold, SEECS_MAX_COMPONENTS. Masks are MAX_COMPONENTS bits,
+// so to compare sizes build with e.g. make PROJECT_CUSTOM_FLAGS=-DSEECS_MAX_COMPONENTS=256.
+// Every entity has slot 0, odd ones slot 1, every third slot 3 and two more
+// spread over the other slots.
+static nlohmann::ordered_json BenchmarkRegistry()
+{
+    constexpr size_t TYPES = seecs::MAX_COMPONENTS;
+    constexpr size_t ENTITIES = 200000;
+    constexpr int RUNS = 7;
+
+    using C0 = SlotComponent<0>;
+    using C1 = SlotComponent<1>;
+    using C3 = SlotComponent<3>;
+    using CMiddle = SlotComponent<TYPES/2>;
+    using CLast = SlotComponent<TYPES - 1>;
+
+    seecs::ECS ecs;
+    RegisterSlotComponents(ecs, std::make_index_sequence<TYPES>{});
+    const std::array<AddSlotFunc, TYPES> adders = MakeSlotAdders(std::make_index_sequence<TYPES>{});
+
+    std::vector<seecs::EntityID> ids(ENTITIES);
+    for (size_t i = 0; i < ENTITIES; i++)
+    {
+        seecs::EntityID id = ids[i] = ecs.CreateEntity();
+        ecs.Add<C0>(id, {});
+        if (i % 2) ecs.Add<C1>(id, {});
+        if (i % 3 == 0) ecs.Add<C3>(id, {});
+        adders[4 + (i*7919) % (TYPES - 4)](ecs, id);
+        adders[4 + (i*104729) % (TYPES - 4)](ecs, id);
+    }
+
+    size_t found = 0;
+    float sum = 0.0f;
+    nlohmann::ordered_json nsPerEntity = {
+        {"has_2", BestNsPerItem(ENTITIES, RUNS, [&] { for (seecs::EntityID id : ids) found += ecs.Has<C1, CLast>(id); })},
+        {"get", BestNsPerItem(ENTITIES, RUNS, [&] { for (seecs::EntityID id : ids) sum += ecs.Get<C0>(id).value; })},
+        {"view_2", BestNsPerItem(ENTITIES, RUNS, [&]
+        {
+            ecs.View<C1, C0>().Each([&](C1& a, C0& b) { sum += a.value + b.value; });
+        })},
+        {"view_3_without_1", BestNsPerItem(ENTITIES, RUNS, [&]
+        {
+            ecs.View<C0, C1, CMiddle>().Without<C3>().Each([&](C0& a, C1&, CMiddle&) { sum += a.value; });
+        })},
+        {"view_1_without_2", BestNsPerItem(ENTITIES, RUNS, [&]
+        {
+            ecs.View<C0>().Without<C3, CLast>().Each([&](C0& a) { sum += a.value; });
+        })}
+    };
+
+    return {
+        {"component_types", TYPES},
+        {"mask_bytes", sizeof(seecs::ComponentMask)},
+        {"entities", ENTITIES},
+        {"runs", RUNS},
+        {"consumed", found + (size_t)sum},
+        {"ns_per_entity", nsPerEntity}
+    };
+}
+
+// Components of the change tracking benchmark's mostly static world
+struct TrackedPosition { float x = 0.0f, y = 0.0f; };
+struct TrackedSize { float width = 1.0f, height = 1.0f; };
+struct TrackedBounds { float minX = 0.0f, minY = 0.0f, maxX = 0.0f, maxY = 0.0f; };
+
+// Ticks of the change tracking benchmark in one setup, fastest tick in ms.
+// Every tick Patch()es the position of 1% of the entities at random, then a
+// consumer recomputes the bounds and serializes {id, x, y} of every entity
+// it visits: all of them, or only the ones Changed<TrackedPosition>() since
+// its last run.
+static nlohmann::ordered_json MeasureChanges(size_t entities, int ticks, bool changedOnly, bool group)
+{
+    using Clock = std::chrono::steady_clock;
+
+    auto ms = [](Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+
+    seecs::ECS ecs;
+    ecs.TrackChanges<TrackedPosition>();
+    if (group) ecs.Group<TrackedPosition, TrackedSize, TrackedBounds>();
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> coordinate(0.0f, 1000.0f);
+    std::vector<seecs::EntityID> ids(entities);
+    for (seecs::EntityID& id : ids)
+    {
+        id = ecs.CreateEntity();
+        ecs.Add<TrackedPosition>(id, { coordinate(rng), coordinate(rng) });
+        ecs.Add<TrackedSize>(id, {});
+        ecs.Add<TrackedBounds>(id, {});
+    }
+
+    struct PacketEntry { seecs::EntityID id; float x, y; };
+    std::vector<PacketEntry> packet;
+    packet.reserve(entities);
+
+    auto consume = [&packet](seecs::EntityID id, TrackedPosition& position, TrackedSize& size, TrackedBounds& bounds)
+    {
+        bounds = { position.x, position.y, position.x + size.width, position.y + size.height };
+        packet.push_back({ id, position.x, position.y });
+    };
+
+    uint32_t lastSeen = ecs.AdvanceTick();
+    double move = std::numeric_limits<double>::max(), pass = move;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < entities/100; i++)
+        {
+            ecs.Patch<TrackedPosition>(ids[rng() % entities], [](TrackedPosition& position) { position.x += 1.0f; });
+        }
+        move = std::min(move, ms(start));
+
+        packet.clear();
+        start = Clock::now();
+        if (changedOnly) ecs.View<TrackedPosition, TrackedSize, TrackedBounds>().Changed<TrackedPosition>(lastSeen).Each(consume);
+        else ecs.View<TrackedPosition, TrackedSize, TrackedBounds>().Each(consume);
+        pass = std::min(pass, ms(start));
+        lastSeen = ecs.AdvanceTick();
+    }
+
+    return {
+        {"move_1_percent", move},
+        {"consumer", pass},
+        {"packet_entries", packet.size()}
+    };
+}
+
+// A mostly static 1M entity world where 1% move per tick: a consumer that
+// walks only Changed<>() entities against one that walks every entity,
+// without and with an owning group over the three components
+static nlohmann::ordered_json BenchmarkChanged()
+{
+    constexpr size_t ENTITIES = 1000000;
+    constexpr int TICKS = 20;
+
+    return {
+        {"entities", ENTITIES},
+        {"moved_per_tick", ENTITIES/100},
+        {"ticks", TICKS},
+        {"ms_per_tick", {
+            {"full_pass", MeasureChanges(ENTITIES, TICKS, false, false)},
+            {"changed", MeasureChanges(ENTITIES, TICKS, true, false)},
+            {"full_pass_group", MeasureChanges(ENTITIES, TICKS, false, true)},
+            {"changed_group", MeasureChanges(ENTITIES, TICKS, true, true)}
+        }}
+    };
+}
+
+struct MicroBenchmark
+{
+    const char* name;
+    nlohmann::ordered_json (*run)();
+};
+
+static const MicroBenchmark MICRO_BENCHMARKS[] = {
+    { "each", BenchmarkEach },
+    { "migrate", BenchmarkMigrate },
+    { "events", BenchmarkEvents },
+    { "churn", BenchmarkChurn },
+    { "bulk", BenchmarkBulk },
+    { "registry", BenchmarkRegistry },
+    { "changed", BenchmarkChanged }
+};
+
+std::vector<std::string> GetMicroBenchmarkNames()
+{
+    std::vector<std::string> names;
+    for (const MicroBenchmark& benchmark : MICRO_BENCHMARKS) names.push_back(benchmark.name);
+    return names;
+}
+
+nlohmann::ordered_json RunMicroBenchmark(const std::string& name)
+{
+    for (const MicroBenchmark& benchmark : MICRO_BENCHMARKS)
+    {
+        if (name != benchmark.name) continue;
+
+        nlohmann::ordered_json report = {{"benchmark", name}};
+        report.update(benchmark.run());
+        return report;
+    }
+    return nullptr;
+}
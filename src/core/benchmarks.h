@@ -0,0 +1,19 @@
+#pragma once
+
+#include "../global.h"
+#include "../utils/json.h"
+
+/**
+ * @brief Names of the ECS micro benchmarks, in the order the usage lists them
+ */
+std::vector<std::string> GetMicroBenchmarkNames();
+
+/**
+ * @brief Run one ECS micro benchmark and return its JSON report
+ * @return A null report if no benchmark has that name
+ *
+ * Micro benchmarks build their own worlds and don't open a window or read
+ * the config, so their numbers only depend on the build and the machine.
+ * Timings are the best of a few runs, the first run also pays for page faults.
+ */
+nlohmann::ordered_json RunMicroBenchmark(const std::string& name);
@@ -0,0 +1,107 @@
+#include "config.h"
+#include "../utils/json.h"
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    // Overwrites value with json[key] when the key is present, throws on a wrong type
+    template <typename T>
+    void Read(const nlohmann::json& json, const char* key, T& value)
+    {
+        auto it = json.find(key);
+        if (it != json.end()) value = it->get<T>();
+    }
+
+    seecs::BroadPhaseMode ParseBroadPhase(const std::string& name)
+    {
+        if (name == "SweepAndPrune") return seecs::BroadPhaseMode::SweepAndPrune;
+        if (name == "AABBTree") return seecs::BroadPhaseMode::AABBTree;
+        if (name == "BruteForce") return seecs::BroadPhaseMode::BruteForce;
+        throw std::invalid_argument("collisionBroadPhase must be SweepAndPrune, AABBTree or BruteForce, not \"" + name + "\"");
+    }
+
+    void Validate(const GameConfig& config)
+    {
+        if ((config.windowWidth <= 0) || (config.windowHeight <= 0)) throw std::invalid_argument("window size must be positive");
+        if (config.targetFPS < 0) throw std::invalid_argument("targetFPS can't be negative");
+        if (!(config.fixedStepHz > 0.0)) throw std::invalid_argument("fixedStepHz must be positive");
+        if (config.boidCount < 0) throw std::invalid_argument("boidCount can't be negative");
+        if ((config.boid.maxSpeed < 0.0f) || (config.boid.maxForce < 0.0f)) throw std::invalid_argument("boid speed and force can't be negative");
+        if ((config.boid.neighborRadius <= 0.0f) || (config.boid.separationRadius <= 0.0f)) throw std::invalid_argument("boid radii must be positive");
+        if (config.eventLogLinesPerSecond < 0) throw std::invalid_argument("eventLogLinesPerSecond can't be negative");
+    }
+}
+
+ConfigFile::ConfigFile(std::string path, std::chrono::milliseconds pollInterval)
+    : m_path(std::move(path)), m_pollInterval(pollInterval)
+{
+}
+
+bool ConfigFile::Load(GameConfig& config)
+{
+    PROFILE_ZONE("config_load");
+
+    // Remember this version even if it's invalid, the next poll waits for another save
+    std::error_code error;
+    m_lastWrite = std::filesystem::last_write_time(m_path, error);
+    m_lastPoll = std::chrono::steady_clock::now();
+
+    std::ifstream file(m_path);
+    if (!file)
+    {
+        m_error = "Can't open " + m_path;
+        return false;
+    }
+
+    GameConfig loaded = config;
+    try
+    {
+        nlohmann::json json = nlohmann::json::parse(file);
+
+        Read(json, "fullscreen", loaded.fullscreen);
+        Read(json, "windowWidth", loaded.windowWidth);
+        Read(json, "windowHeight", loaded.windowHeight);
+        Read(json, "targetFPS", loaded.targetFPS);
+
+        Read(json, "fixedStepHz", loaded.fixedStepHz);
+        Read(json, "boidCount", loaded.boidCount);
+        Read(json, "boidMaxSpeed", loaded.boid.maxSpeed);
+        Read(json, "boidMaxForce", loaded.boid.maxForce);
+        Read(json, "boidNeighborRadius", loaded.boid.neighborRadius);
+        Read(json, "boidSeparationRadius", loaded.boid.separationRadius);
+        Read(json, "separationWeight", loaded.boidWeights.separation);
+        Read(json, "alignmentWeight", loaded.boidWeights.alignment);
+        Read(json, "cohesionWeight", loaded.boidWeights.cohesion);
+        Read(json, "targetWeight", loaded.boidWeights.target);
+        Read(json, "eventLogLinesPerSecond", loaded.eventLogLinesPerSecond);
+
+        std::string broadPhase;
+        Read(json, "collisionBroadPhase", broadPhase);
+        if (!broadPhase.empty()) loaded.broadPhase = ParseBroadPhase(broadPhase);
+
+        Validate(loaded);
+    }
+    catch (const std::exception& e)
+    {
+        m_error = m_path + ": " + e.what();
+        return false;
+    }
+
+    config = loaded;
+    m_error.clear();
+    return true;
+}
+
+bool ConfigFile::PollChanges(GameConfig& config)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastPoll < m_pollInterval) return false;
+    m_lastPoll = now;
+
+    std::error_code error;
+    std::filesystem::file_time_type lastWrite = std::filesystem::last_write_time(m_path, error);
+    if (error || (lastWrite == m_lastWrite)) return false;
+
+    return Load(config);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../global.h"
+#include <chrono>
+#include <filesystem>
+
+/**
+ * @brief Settings read from resources/config.json
+ *
+ * Defaults are the compile-time values from constants.h and the component
+ * defaults, so a missing file or key changes nothing. Window settings are
+ * applied when the window opens; everything else also applies on hot reload.
+ */
+struct GameConfig
+{
+    // Window
+    bool fullscreen = false;
+    int windowWidth = DEFAULT_WINDOW_WIDTH;
+    int windowHeight = DEFAULT_WINDOW_HEIGHT;
+    int targetFPS = TARGET_FPS;
+
+    // Simulation
+    double fixedStepHz = 60.0;                      // Fixed updates per second
+    int boidCount = 100;                            // Boids kept alive, --boids overrides it
+    seecs::components::Boid boid;                   // Speed, force and radii every boid gets
+    seecs::systems::boid_system::BoidWeights boidWeights;
+    seecs::BroadPhaseMode broadPhase = COLLISION_BROAD_PHASE;
+    int eventLogLinesPerSecond = EVENT_LOG_LINES_PER_SECOND; // 0 disables the log
+};
+
+/**
+ * @brief Loads a GameConfig from a JSON file and watches it for changes
+ *
+ * Keys are optional, unknown keys are ignored. A file that fails to parse or
+ * holds an invalid value leaves the config untouched, so a half-saved edit
+ * doesn't break a running game.
+ */
+class ConfigFile
+{
+public:
+    explicit ConfigFile(std::string path, std::chrono::milliseconds pollInterval = std::chrono::milliseconds(500));
+
+    /**
+     * @brief Parse the file into config
+     * @return False if the file is missing or invalid, see GetError()
+     */
+    bool Load(GameConfig& config);
+
+    /**
+     * @brief Reload when the file's modification time changed since the last load
+     * @return True if config was updated
+     *
+     * Cheap to call every frame, the file is only checked once per poll interval.
+     */
+    bool PollChanges(GameConfig& config);
+
+    const std::string& GetPath() const { return m_path; }
+    const std::string& GetError() const { return m_error; }
+
+private:
+    std::string m_path;
+    std::string m_error;
+    std::chrono::milliseconds m_pollInterval;
+    std::chrono::steady_clock::time_point m_lastPoll;
+    std::filesystem::file_time_type m_lastWrite;
+};
@@ -18,4 +18,10 @@ const std::string GAME_ORG = "CuriosiLab";
 
 // Window settings
 const int DEFAULT_WINDOW_WIDTH = 1024;
-const int DEFAULT_WINDOW_HEIGHT = 768;
\ No newline at end of file
+const int DEFAULT_WINDOW_HEIGHT = 768;
+
+// Collision broad phase: SweepAndPrune, AABBTree or BruteForce
+#define COLLISION_BROAD_PHASE seecs::BroadPhaseMode::SweepAndPrune
+
+// Collision and death event log, max lines per second (0 disables it)
+#define EVENT_LOG_LINES_PER_SECOND 20
@@ -1,10 +1,27 @@
 #include "game.h"
+#include "../utils/json.h"
 #include <sstream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
 
 // Game Implementation
-Game::Game() : systemManager(nullptr)
+Game::Game(const GameOptions& options) : options(options), jobs(options.threads), systemManager(nullptr), configFile(options.configPath)
 {
-    // Constructor - initialize member variables
+    using namespace seecs::components;
+
+    // Names are part of the file format, keep them when renaming the types.
+    // Sprites aren't saved, their textures don't outlive the process.
+    snapshot.Register<Transform>("Transform");
+    snapshot.Register<Motion>("Motion");
+    snapshot.Register<Boid>("Boid");
+    snapshot.Register<Collider>("Collider");
+    snapshot.Register<Health>("Health");
+    snapshot.Register<PlayerControlled>("PlayerControlled");
+    snapshot.Register<AIControlled>("AIControlled");
+    snapshot.Register<Name>("Name",
+        [](seecs::SnapshotWriter& writer, const Name& name) { writer.WriteString(name.value); },
+        [](seecs::SnapshotReader& reader, Name& name) { reader.ReadString(name.value); });
 }
 
 Game::~Game()
@@ -19,23 +36,61 @@ bool Game::Initialize()
     ss << GAME_TITLE << " v" << VERSION_MAJOR << "." << VERSION_MINOR << "." << VERSION_PATCH;
     std::string windowTitle = ss.str();
 
-    // Initialize raylib
-    InitWindow(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT, windowTitle.c_str());
-    SetExitKey(KEY_NULL); // Disable default exit key (ESC)
-    InitAudioDevice();
-    SetTargetFPS(TARGET_FPS);
+    if (!options.tracePath.empty()) seecs::Profiler::Get().StartCapture();
+
+    // Settings first, the window is created from them
+    if (!configFile.Load(config)) std::cerr << configFile.GetError() << ", using defaults" << std::endl;
+    lastConfigError = configFile.GetError();
+    if (options.boids >= 0) config.boidCount = options.boids;
+
+    // Initialize raylib, headless runs only use its math and random helpers
+    if (!options.headless)
+    {
+        InitWindow(config.windowWidth, config.windowHeight, windowTitle.c_str());
+        if (config.fullscreen) ToggleFullscreen();
+        SetExitKey(KEY_NULL); // Disable default exit key (ESC)
+        InitAudioDevice();
+        SetTargetFPS(config.targetFPS);
+        windowOpen = true;
+    }
 
     // Seed random number generator
-    srand((unsigned)time(NULL));
+    unsigned int seed = (options.seed != 0)? options.seed : (unsigned)time(NULL);
+    srand(seed);
+    SetRandomSeed(seed);
 
     // Initialize ECS and systems
-    systemManager = new seecs::systems::SystemManager(ecs);
+    systemManager = new seecs::systems::SystemManager(ecs, jobs);
+    systemManager->SetBruteForceNeighbors(options.bruteForceNeighbors);
+    ApplyConfig(config, true);
 
     // Components will be registered automatically when first used
     // No need to call RegisterComponent() explicitly
 
-    // Set up the boids example
-    SetupBoidsExample();
+    // Set up the boids example, or restore a saved world
+    auto setupStart = std::chrono::steady_clock::now();
+    if (!options.loadWorldPath.empty())
+    {
+        if (!LoadWorld(options.loadWorldPath)) return false;
+    }
+    else
+    {
+        SetupBoidsExample();
+    }
+    setupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setupStart).count();
+
+    if (!options.saveWorldPath.empty() && !snapshot.Save(ecs, options.saveWorldPath))
+    {
+        std::cerr << snapshot.GetError() << std::endl;
+        return false;
+    }
+
+    // Headless runs keep stdout for the report
+    if (!options.headless)
+    {
+        std::cout << "System schedule:\n" << systemManager->GetScheduler().DescribeSchedule();
+        std::cout << "Boid kernels: " << GetSimdLevelName(DetectSimdLevel()) << std::endl;
+    }
 
     return true;
 }
@@ -44,52 +99,253 @@ void Game::Run()
 {
     while (!WindowShouldClose())
     {
+        // Retune the running game when the settings file is saved
+        GameConfig previous = config;
+        if (configFile.PollChanges(config))
+        {
+            if (options.boids >= 0) config.boidCount = options.boids;
+            ApplyConfig(previous, false);
+            std::cout << "Reloaded " << configFile.GetPath() << std::endl;
+        }
+        else if (!configFile.GetError().empty() && (configFile.GetError() != lastConfigError))
+        {
+            std::cerr << configFile.GetError() << ", keeping the previous settings" << std::endl;
+        }
+        lastConfigError = configFile.GetError();
+
         double dt = GetFrameTime();
         accumulator += dt;
 
         // Fixed timestep updates
-        while (accumulator >= FIXED_DT)
+        while (accumulator >= fixedDt)
         {
-            UpdateFixed(FIXED_DT);
-            accumulator -= FIXED_DT;
+            UpdateFixed(fixedDt);
+            accumulator -= fixedDt;
         }
 
+        UpdateCamera();
         DrawFrame();
+        seecs::Profiler::Get().EndFrame();
+    }
+}
+
+bool WriteReport(const nlohmann::ordered_json& report, const std::string& path)
+{
+    if (path.empty())
+    {
+        std::cout << report.dump(4) << std::endl;
+        return true;
+    }
+
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "Can't write report to " << path << std::endl;
+        return false;
+    }
+    file << report.dump(4) << std::endl;
+    return true;
+}
+
+bool Game::RunHeadless()
+{
+    return WriteReport(RunBenchmark(), options.reportPath);
+}
+
+nlohmann::ordered_json Game::RunBenchmark()
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<double> tickMs;
+    tickMs.reserve(options.ticks);
+
+    // CPU side of rendering, the same work Render() does before submitting to the GPU
+    std::vector<double> renderMs;
+    size_t renderVertices = 0;
+    seecs::systems::render_system::CullStats renderCulling;
+    double renderSeconds = 0.0;
+
+    Clock::time_point start = Clock::now();
+    for (int tick = 0; tick < options.ticks; tick++)
+    {
+        systemManager->SetBoidTarget(GetScriptedTarget(tick));
+
+        Clock::time_point tickStart = Clock::now();
+        UpdateFixed((float)fixedDt);
+        Clock::time_point tickEnd = Clock::now();
+        tickMs.push_back(std::chrono::duration<double, std::milli>(tickEnd - tickStart).count());
+
+        if (options.renderBuild)
+        {
+            const auto& batch = systemManager->BuildRenderBatch((float)config.windowWidth, (float)config.windowHeight);
+            renderVertices = batch.boidVertices.size() + 4*batch.sprites.size();
+            renderCulling = batch.stats;
+            renderMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - tickEnd).count());
+            renderSeconds += renderMs.back()/1000.0;
+        }
+
+        seecs::Profiler::Get().EndFrame();
+    }
+    // Simulation only, render builds are reported on their own
+    double totalSeconds = std::chrono::duration<double>(Clock::now() - start).count() - renderSeconds;
+
+    // FNV-1a over the final positions, equal checksums mean the runs simulated the same thing
+    uint64_t checksum = 1469598103934665603ull;
+    ecs.View<seecs::components::Transform>().Each([&](seecs::components::Transform& transform)
+    {
+        uint32_t bits[2];
+        memcpy(bits, &transform.position, sizeof(bits));
+        for (uint32_t word : bits)
+        {
+            checksum ^= word;
+            checksum *= 1099511628211ull;
+        }
+    });
+
+    auto percentile = [](const std::vector<double>& samples, double p)
+    {
+        if (samples.empty()) return 0.0;
+        std::vector<double> sorted = samples;
+        size_t index = std::min(sorted.size() - 1, (size_t)(p*sorted.size()));
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    };
+
+    nlohmann::ordered_json report = {
+        {"ticks", options.ticks},
+        {"boids", config.boidCount},
+        {"world_screens", options.worldScreens},
+        {"entities", ecs.GetEntityCount()},
+        {"seed", options.seed},
+        {"threads", jobs.GetThreadCount()},
+        {"simd", GetSimdLevelName(DetectSimdLevel())},
+        {"broad_phase", seecs::GetBroadPhaseName(config.broadPhase)},
+        {"neighbors", options.bruteForceNeighbors? "brute_force" : "grid"},
+        {"setup", options.loadWorldPath.empty()? "spawned" : "snapshot"},
+        {"setup_ms", setupMs},
+        {"total_seconds", totalSeconds},
+        {"ticks_per_second", (totalSeconds > 0.0)? options.ticks/totalSeconds : 0.0},
+        {"tick_ms", {
+            {"p50", percentile(tickMs, 0.50)},
+            {"p99", percentile(tickMs, 0.99)},
+            {"max", tickMs.empty()? 0.0 : *std::max_element(tickMs.begin(), tickMs.end())}
+        }},
+        {"ecs_memory_bytes", ecs.GetMemoryUsage()},
+        {"checksum", std::to_string(checksum)}
+    };
+
+    if (options.renderBuild)
+    {
+        report["render_build_ms"] = {
+            {"p50", percentile(renderMs, 0.50)},
+            {"p99", percentile(renderMs, 0.99)},
+            {"max", renderMs.empty()? 0.0 : *std::max_element(renderMs.begin(), renderMs.end())}
+        };
+        report["render_vertices"] = renderVertices;
+        report["render_culling"] = {
+            {"boids_drawn", renderCulling.boidsDrawn},
+            {"boids_culled", renderCulling.boidsCulled},
+            {"sprites_drawn", renderCulling.spritesDrawn},
+            {"sprites_culled", renderCulling.spritesCulled}
+        };
     }
+
+    // Profiler zones over the last ticks, empty when built with PROFILER_ENABLED=0
+    nlohmann::ordered_json zones = nlohmann::ordered_json::object();
+    for (const seecs::Profiler::ZoneStats& zone : seecs::Profiler::Get().GetStats())
+    {
+        zones[zone.name] = {{"min", zone.minMs}, {"avg", zone.averageMs}, {"p99", zone.p99Ms}};
+    }
+    report["profile_ms"] = zones;
+
+    return report;
 }
 
 void Game::Shutdown()
 {
     if (systemManager)
     {
+        if (!options.tracePath.empty() && !seecs::Profiler::Get().WriteChromeTrace(options.tracePath))
+        {
+            std::cerr << "Can't write trace to " << options.tracePath << std::endl;
+        }
+
         delete systemManager;
         systemManager = nullptr;
     }
 
-    CloseAudioDevice();
-    CloseWindow();
+    if (windowOpen)
+    {
+        CloseAudioDevice();
+        CloseWindow();
+        windowOpen = false;
+    }
 }
 
 void Game::UpdateFixed(float dt)
 {
     if (systemManager)
     {
+        if (windowOpen) systemManager->SetBoidTarget(GetScreenToWorld2D(GetMousePosition(), systemManager->GetCamera()));
         systemManager->Update(dt);
     }
 }
 
+Vector2 Game::GetScriptedTarget(int tick) const
+{
+    float t = (float)(tick*fixedDt);
+    return {
+        config.windowWidth*(0.5f + 0.35f*cosf(0.7f*t)),
+        config.windowHeight*(0.5f + 0.35f*sinf(1.1f*t))
+    };
+}
+
 void Game::SetupBoidsExample()
 {
-    // Create boids with random positions and velocities
-    const int NUM_BOIDS = 100;
+    SpawnBoids(config.boidCount);
+
+    if (options.headless) return;
+
+    std::cout << "Boids Example Setup Complete!" << std::endl;
+    std::cout << "Created " << config.boidCount << " boids" << std::endl;
+    std::cout << "Move your mouse to guide the boids!" << std::endl;
+}
+
+bool Game::LoadWorld(const std::string& path)
+{
+    PROFILE_ZONE("world_load");
 
-    for (int i = 0; i < NUM_BOIDS; ++i)
+    if (!snapshot.Load(ecs, path))
     {
-        auto boid = ecs.CreateEntity(std::string("Boid_") + std::to_string(i));
+        std::cerr << snapshot.GetError() << std::endl;
+        return false;
+    }
+
+    // The loaded flock replaces the configured one until the config is reloaded
+    config.boidCount = 0;
+    ecs.View<seecs::components::Boid>().Each([&](seecs::components::Boid&) { config.boidCount++; });
+    boidsSpawned = (int)ecs.GetEntityCount();
 
-        // Random position within screen bounds
-        float x = (float)GetRandomValue(50, DEFAULT_WINDOW_WIDTH - 50);
-        float y = (float)GetRandomValue(50, DEFAULT_WINDOW_HEIGHT - 50);
+    if (!options.headless) std::cout << "Loaded " << ecs.GetEntityCount() << " entities from " << path << std::endl;
+    return true;
+}
+
+void Game::SpawnBoids(int count)
+{
+    // The world keeps the screen's aspect ratio
+    const float worldSide = sqrtf(options.worldScreens);
+    const int worldWidth = (int)(config.windowWidth*worldSide);
+    const int worldHeight = (int)(config.windowHeight*worldSide);
+
+    // Create every boid in one call, then fill in the random parts
+    std::span<const seecs::EntityID> boids = ecs.CreateEntities((size_t)count,
+        seecs::components::Transform{}, seecs::components::Motion{}, config.boid, seecs::components::Name{});
+
+    for (seecs::EntityID boid : boids)
+    {
+        // Random position within world bounds
+        float x = (float)GetRandomValue(50, worldWidth - 50);
+        float y = (float)GetRandomValue(50, worldHeight - 50);
 
         // Random initial velocity
         float angle = (float)GetRandomValue(0, 360) * DEG2RAD;
@@ -97,16 +353,77 @@ void Game::SetupBoidsExample()
         float vx = cos(angle) * speed;
         float vy = sin(angle) * speed;
 
-        ecs.Add<seecs::components::Transform>(boid, {{x, y}, 0.0f, {1.0f, 1.0f}});
-        ecs.Add<seecs::components::Motion>(boid, {{vx, vy}, {0.0f, 0.0f}});
-        ecs.Add<seecs::components::Boid>(boid);
-        ecs.Add<seecs::components::Name>(boid, {std::string("Boid_") + std::to_string(i)});
+        ecs.Get<seecs::components::Transform>(boid).position = {x, y};
+        ecs.Get<seecs::components::Motion>(boid).velocity = {vx, vy};
+        ecs.Get<seecs::components::Name>(boid).value = std::string("Boid_") + std::to_string(boidsSpawned++);
     }
+}
 
-    std::cout << "Boids Example Setup Complete!" << std::endl;
-    std::cout << "Created " << NUM_BOIDS << " boids" << std::endl;
-    std::cout << "Move your mouse to guide the boids!" << std::endl;
-}void Game::DrawFrame()
+void Game::ApplyConfig(const GameConfig& previous, bool startup)
+{
+    fixedDt = 1.0/config.fixedStepHz;
+    systemManager->SetBoidWeights(config.boidWeights);
+    systemManager->SetCollisionBroadPhase(config.broadPhase);
+
+    // Headless runs keep stdout for the report
+    if (!options.headless && (startup || (config.eventLogLinesPerSecond != previous.eventLogLinesPerSecond)))
+    {
+        systemManager->SetEventLog((size_t)config.eventLogLinesPerSecond);
+    }
+
+    // Window settings were used to open the window, boids are spawned from the config afterwards
+    if (startup) return;
+
+    if (windowOpen)
+    {
+        if (config.targetFPS != previous.targetFPS) SetTargetFPS(config.targetFPS);
+        if ((config.windowWidth != previous.windowWidth) || (config.windowHeight != previous.windowHeight)) SetWindowSize(config.windowWidth, config.windowHeight);
+        if (config.fullscreen != IsWindowFullscreen()) ToggleFullscreen();
+    }
+
+    // Every boid shares the configured parameters
+    std::vector<seecs::EntityID> boids;
+    ecs.View<seecs::components::Boid>().Each([&](seecs::EntityID id, seecs::components::Boid& boid)
+    {
+        boid = config.boid;
+        boids.push_back(id);
+    });
+
+    // Grow or shrink the flock to the configured count. Shrinking removes the
+    // boids at the end of the Boid pool's dense order: appended boids land
+    // there, but every delete swaps the last boid into the freed spot, so
+    // these are not strictly the newest.
+    if (config.boidCount > (int)boids.size()) SpawnBoids(config.boidCount - (int)boids.size());
+    if ((size_t)config.boidCount < boids.size()) ecs.DestroyEntities(std::span(boids).subspan((size_t)config.boidCount));
+}
+
+void Game::UpdateCamera()
+{
+    if (!systemManager) return;
+
+    Camera2D camera = systemManager->GetCamera();
+
+    if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT))
+    {
+        Vector2 delta = GetMouseDelta();
+        camera.target.x -= delta.x/camera.zoom;
+        camera.target.y -= delta.y/camera.zoom;
+    }
+
+    float wheel = GetMouseWheelMove();
+    if (wheel != 0.0f)
+    {
+        // Zoom around the cursor, the world point under it stays put
+        Vector2 mouse = GetMousePosition();
+        camera.target = GetScreenToWorld2D(mouse, camera);
+        camera.offset = mouse;
+        camera.zoom = Clamp(camera.zoom*(1.0f + 0.1f*wheel), 0.05f, 10.0f);
+    }
+
+    systemManager->SetCamera(camera);
+}
+
+void Game::DrawFrame()
 {
     BeginDrawing();
     ClearBackground(RAYWHITE);
@@ -119,5 +436,6 @@ void Game::SetupBoidsExample()
 
     DRAW_FPS;
     DRAW_MOUSE_POS;
+    DRAW_PROFILER;
     EndDrawing();
 }
\ No newline at end of file
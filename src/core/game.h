@@ -1,6 +1,38 @@
 #pragma once
 
 #include "../global.h"
+#include "config.h"
+#include "../utils/json.h"
+#include "../utils/snapshot.h"
+
+/**
+ * @brief Startup options, filled from the command line
+ */
+struct GameOptions
+{
+    bool headless = false;      // No window or audio, run a fixed number of ticks and report timings
+    int ticks = 1000;           // Ticks simulated by a headless run
+    int boids = -1;             // Boids created at startup, -1 takes boidCount from the config
+    unsigned int seed = 0;      // Random seed, 0 seeds from the clock
+    size_t threads = 0;         // Worker threads including the main one, 0 uses every core
+    std::string reportPath;     // Headless JSON report file, printed to stdout when empty
+    bool selfCheck = false;     // Compare every broad phase mode against brute force on random boxes, then exit
+    bool threadSweep = false;   // Headless: rerun on 1, 2, 4... up to `threads` threads and report the scaling
+    bool renderBuild = false;   // Headless: also build the render batch every tick and time it
+    float worldScreens = 1.0f;  // World area in screens, the camera starts on the top-left one
+    std::string tracePath;      // Chrome trace of every profiler zone, written at shutdown when set
+    std::string configPath = "resources/config.json"; // Hot reloaded while the window is open
+    std::string loadWorldPath;  // World snapshot loaded instead of spawning boids
+    std::string saveWorldPath;  // World snapshot written once the world is set up
+    bool bruteForceNeighbors = false; // Find boid neighbors by scanning every boid, to compare against the grid
+    std::string microBenchmark; // ECS micro benchmark run instead of the game, see benchmarks.h
+};
+
+/**
+ * @brief Write a JSON report to path, or to stdout when path is empty
+ * @return False if the file couldn't be written
+ */
+bool WriteReport(const nlohmann::ordered_json& report, const std::string& path);
 
 /**
  * @brief Main Game class that manages the application lifecycle
@@ -11,16 +43,32 @@
 class Game
 {
 private:
-    // ECS instance and system manager
+    GameOptions options;
+
+    // ECS instance, worker threads and system manager
     seecs::ECS ecs;
+    JobSystem jobs;
     seecs::systems::SystemManager* systemManager;
 
+    // Settings, reloaded when the file changes
+    GameConfig config;
+    ConfigFile configFile;
+
     // Fixed timestep timing
-    const double FIXED_DT = 1.0 / 60.0;
+    double fixedDt = 1.0 / 60.0;
     double accumulator = 0.0;
 
+    std::string lastConfigError; // Printed once per failed reload
+    int boidsSpawned = 0;        // Numbers boid names, never reused
+
+    // Components saved in world snapshots
+    seecs::WorldSnapshot snapshot;
+    double setupMs = 0.0;        // Spawning or loading the starting world
+
+    bool windowOpen = false;
+
 public:
-    Game();
+    explicit Game(const GameOptions& options = GameOptions());
     ~Game();
 
     /**
@@ -34,6 +82,20 @@ public:
      */
     void Run();
 
+    /**
+     * @brief Run options.ticks fixed updates without a window and write the JSON report
+     * @return true if the report could be written
+     *
+     * Boids follow a scripted target instead of the mouse, so runs with the
+     * same seed, boid count and tick count simulate the same thing.
+     */
+    bool RunHeadless();
+
+    /**
+     * @brief Simulate like RunHeadless() and return the report instead of writing it
+     */
+    nlohmann::ordered_json RunBenchmark();
+
     /**
      * @brief Cleanup and shutdown the game
      */
@@ -46,6 +108,16 @@ private:
      */
     void UpdateFixed(float dt);
 
+    /**
+     * @brief Target the boids follow in headless runs, a Lissajous curve around the screen center
+     */
+    Vector2 GetScriptedTarget(int tick) const;
+
+    /**
+     * @brief Pan the camera while the right mouse button is held, zoom with the wheel
+     */
+    void UpdateCamera();
+
     /**
      * @brief Render the current frame
      */
@@ -55,5 +127,23 @@ private:
      * @brief Set up the boids example with entities and components
      */
     void SetupBoidsExample();
+
+    /**
+     * @brief Replace the world with the snapshot in path
+     * @return False if the snapshot couldn't be loaded, the world is left empty
+     */
+    bool LoadWorld(const std::string& path);
+
+    /**
+     * @brief Create count boids at random positions in the world
+     */
+    void SpawnBoids(int count);
+
+    /**
+     * @brief Push the config to the systems and existing boids
+     * @param previous Config applied before, settings that didn't change are left alone
+     * @param startup First call, the boids don't exist yet
+     */
+    void ApplyConfig(const GameConfig& previous, bool startup);
 };
 
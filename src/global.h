@@ -22,7 +22,9 @@
 #if DEBUG_MODE
     #define DRAW_FPS DrawText(std::format("FPS: {}", GetFPS()).c_str(), 10, 10, 20, RED)
     #define DRAW_MOUSE_POS DrawText(std::format("Mouse: ({}, {})", (int)GetMouseX(), (int)GetMouseY()).c_str(), 10, 30, 20, RED)
+    #define DRAW_PROFILER seecs::Profiler::Get().DrawOverlay(10, 55)
 #else
     #define DRAW_FPS
     #define DRAW_MOUSE_POS
+    #define DRAW_PROFILER
 #endif
\ No newline at end of file
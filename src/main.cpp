@@ -1,5 +1,10 @@
 #include "raylib.h"
 #include "core/game.h"
+#include "core/benchmarks.h"
+#include <random>
+#include <chrono>
+#include <limits>
+#include <cfloat>
 
 #if defined(PLATFORM_WEB)
     #include <emscripten/emscripten.h>
@@ -17,9 +22,386 @@ static void MainLoop()
     }
 }
 
-int main(void)
+static void PrintUsage(const char* program)
 {
-    Game game;
+    std::string benchmarks;
+    for (const std::string& name : GetMicroBenchmarkNames()) benchmarks += (benchmarks.empty()? "" : ", ") + name;
+
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --headless       Run without a window and print a JSON timing report\n"
+              << "  --ticks N        Ticks simulated by a headless run (default 1000)\n"
+              << "  --boids N        Boids created at startup, overrides boidCount from the config\n"
+              << "  --seed N         Random seed, 0 seeds from the clock (headless default 1)\n"
+              << "  --threads N      Threads including the main one, 0 uses every core\n"
+              << "  --self-check     Check the broad phase modes against brute force and the SIMD boid kernels against scalar, then exit\n"
+              << "  --thread-sweep   Headless: run on 1, 2, 4... up to --threads threads and report the scaling\n"
+              << "  --report FILE    Write the headless report to FILE instead of stdout\n"
+              << "  --render         Headless: also time building the render batch every tick\n"
+              << "  --world N        World area in screens, boids spawn across all of it (default 1)\n"
+              << "  --trace FILE     Write a Chrome trace of the profiler zones to FILE on exit\n"
+              << "  --config FILE    Settings file (default resources/config.json)\n"
+              << "  --load-world FILE  Start from a world snapshot instead of spawning boids\n"
+              << "  --save-world FILE  Write a world snapshot once the world is set up\n"
+              << "  --brute-neighbors  Find boid neighbors by scanning every boid instead of the grid\n"
+              << "  --bench NAME     Run an ECS micro benchmark instead of the game and report it: " << benchmarks << "\n";
+}
+
+// Fills options from the command line, returns false on unknown or incomplete arguments
+static bool ParseCommandLine(int argc, char* argv[], GameOptions& options)
+{
+    bool seedGiven = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--headless") options.headless = true;
+        else if ((arg == "--ticks") && hasValue) options.ticks = std::max(0, atoi(argv[++i]));
+        else if ((arg == "--boids") && hasValue) options.boids = std::max(0, atoi(argv[++i]));
+        else if ((arg == "--seed") && hasValue)
+        {
+            options.seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+            seedGiven = true;
+        }
+        else if ((arg == "--threads") && hasValue) options.threads = (size_t)strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--self-check") options.selfCheck = true;
+        else if (arg == "--thread-sweep") options.threadSweep = true;
+        else if ((arg == "--report") && hasValue) options.reportPath = argv[++i];
+        else if (arg == "--render") options.renderBuild = true;
+        else if ((arg == "--config") && hasValue) options.configPath = argv[++i];
+        else if ((arg == "--trace") && hasValue) options.tracePath = argv[++i];
+        else if ((arg == "--load-world") && hasValue) options.loadWorldPath = argv[++i];
+        else if ((arg == "--save-world") && hasValue) options.saveWorldPath = argv[++i];
+        else if (arg == "--brute-neighbors") options.bruteForceNeighbors = true;
+        else if ((arg == "--bench") && hasValue) options.microBenchmark = argv[++i];
+        else if ((arg == "--world") && hasValue) options.worldScreens = std::max(1.0f, (float)atof(argv[++i]));
+        else return false;
+    }
+
+    // Benchmarks should be repeatable unless asked otherwise
+    if (options.headless && !seedGiven) options.seed = 1;
+
+    return true;
+}
+
+// Feeds randomly moving, appearing and disappearing boxes to one BroadPhase per
+// mode for a few hundred ticks and checks each reports the brute force pairs.
+// The persistent modes only keep their proxies in sync if they see every tick,
+// so the instances live for the whole run. One more switches modes as it goes.
+static bool RunBroadPhaseSelfCheck(unsigned int seed)
+{
+    constexpr int TICKS = 600;
+    constexpr size_t MAX_BOXES = 400;
+    constexpr float WORLD = 1000.0f;
+
+    std::mt19937 rng(seed);
+    auto uniform = [&rng](float min, float max) { return std::uniform_real_distribution<float>(min, max)(rng); };
+
+    std::vector<seecs::EntityID> ids;
+    std::vector<Rectangle> rects;
+    std::vector<Vector2> velocities;
+    seecs::EntityID nextId = 1;
+
+    auto spawn = [&]()
+    {
+        // Mostly small boxes, some large ones spanning many others, some on a shared grid so edges touch exactly
+        float size = (rng()%10 == 0)? uniform(50.0f, 300.0f) : uniform(0.0f, 30.0f);
+        Rectangle rect = { uniform(0.0f, WORLD), uniform(0.0f, WORLD), size, uniform(0.0f, 30.0f) };
+        if (rng()%4 == 0) rect = { 10.0f*(float)(rng()%100), 10.0f*(float)(rng()%100), 10.0f, 10.0f };
+
+        ids.push_back(nextId++);
+        rects.push_back(rect);
+        velocities.push_back({ uniform(-3.0f, 3.0f), uniform(-3.0f, 3.0f) });
+    };
+
+    const seecs::BroadPhaseMode modes[] = { seecs::BroadPhaseMode::SweepAndPrune, seecs::BroadPhaseMode::AABBTree };
+    seecs::BroadPhase reference;
+    seecs::BroadPhase phases[3];
+    reference.SetMode(seecs::BroadPhaseMode::BruteForce);
+    phases[0].SetMode(modes[0]);
+    phases[1].SetMode(modes[1]);
+
+    std::vector<seecs::CollisionPair> expected, found;
+    size_t pairsChecked = 0;
+
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        // Churn: drop random boxes, swap-removing so the input order changes too, then refill
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            if (rng()%50 != 0) continue;
+            ids[i] = ids.back(); ids.pop_back();
+            rects[i] = rects.back(); rects.pop_back();
+            velocities[i] = velocities.back(); velocities.pop_back();
+        }
+        while (ids.size() < MAX_BOXES && rng()%8 != 0) spawn();
+
+        for (size_t i = 0; i < rects.size(); i++)
+        {
+            // Small steps stay inside the tree's fat boxes, the odd teleport forces a reinsert
+            if (rng()%100 == 0)
+            {
+                rects[i].x = uniform(0.0f, WORLD);
+                rects[i].y = uniform(0.0f, WORLD);
+            }
+            rects[i].x += velocities[i].x;
+            rects[i].y += velocities[i].y;
+        }
+
+        phases[2].SetMode(modes[(tick/50)%2]);
+
+        reference.FindPairs(ids.data(), rects.data(), ids.size(), expected);
+        for (int p = 0; p < 3; p++)
+        {
+            phases[p].FindPairs(ids.data(), rects.data(), ids.size(), found);
+            if (found == expected) continue;
+
+            std::cerr << "Broad phase self-check failed: " << seecs::GetBroadPhaseName(phases[p].GetMode())
+                      << " found " << found.size() << " pairs, brute force " << expected.size()
+                      << " on tick " << tick << " (seed " << seed << ")" << std::endl;
+            return false;
+        }
+        pairsChecked += expected.size();
+    }
+
+    std::cout << "Broad phase self-check passed: " << TICKS << " ticks, " << pairsChecked << " pairs (seed " << seed << ")" << std::endl;
+    return true;
+}
+
+// Runs every boid kernel set this CPU supports on the same random flock and
+// compares it with the scalar kernels, then times each set. SIMD kernels add
+// the neighbor sums up in a different order, so the check is in two steps:
+//  - Accumulate: neighbor counts must match exactly. Adding n terms of up to
+//    size t in any order is off by at most (n - 1)*n*t*FLT_EPSILON/2 from the
+//    exact sum, so two orders may differ by twice that.
+//  - Finalize: given the scalar sums, forces and velocities must match to
+//    FINALIZE_TOLERANCE of maxForce and maxSpeed.
+// Comparing accelerations after both steps isn't a fixed bound: cohesion turns
+// a rounding error in the average neighbor position into a direction error that
+// grows the closer a boid is to that average, see boid_kernels.h.
+static bool RunBoidKernelSelfCheck(unsigned int seed)
+{
+    using namespace seecs::systems::boid_system;
+
+    constexpr size_t BOIDS = 20000;
+    constexpr float WORLD = 5600.0f;            // About 100 boids per 400x400, like a one-screen flock
+    constexpr float FINALIZE_TOLERANCE = 1e-5f;
+    constexpr float DT = 1.0f/60.0f;
+    constexpr int RUNS = 5;
+
+    std::mt19937 rng(seed);
+    auto uniform = [&rng](float min, float max) { return std::uniform_real_distribution<float>(min, max)(rng); };
+
+    const seecs::components::Boid boid;
+    const BoidWeights weights;
+    const Vector2 target = { WORLD*0.5f, WORLD*0.5f };
+
+    seecs::FrameArena arena;
+    BoidSoA soa;
+    soa.Allocate(arena, BOIDS);
+    for (size_t i = 0; i < BOIDS; i++)
+    {
+        soa.posX[i] = uniform(0.0f, WORLD);
+        soa.posY[i] = uniform(0.0f, WORLD);
+        soa.velX[i] = uniform(-boid.maxSpeed, boid.maxSpeed)*0.5f;
+        soa.velY[i] = uniform(-boid.maxSpeed, boid.maxSpeed)*0.5f;
+        soa.maxSpeed[i] = boid.maxSpeed;
+        soa.maxForce[i] = boid.maxForce;
+        soa.separationRadius[i] = boid.separationRadius;
+        soa.neighborRadius[i] = boid.neighborRadius;
+    }
+    soa.Pad(BOIDS);
+
+    seecs::SpatialHashGrid grid;
+    grid.Build(BOIDS, [&](size_t i) { return Vector2{soa.posX[i], soa.posY[i]}; }, std::max(boid.neighborRadius, boid.separationRadius));
+    soa.SortByGrid(grid);
+
+    // Every neighbor sum with its term count and a bound on one term's size.
+    // Separation adds dx/d^2, at most 1/d, which only the closest pair bounds.
+    struct SumColumn { std::span<float> BoidSoA::* sum; std::span<float> BoidSoA::* count; float term; };
+    float closest = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < BOIDS; i++)
+    {
+        uint32_t rangeBegin[9], rangeEnd[9];
+        int rangeCount = grid.GetNearRanges({soa.posX[i], soa.posY[i]}, rangeBegin, rangeEnd);
+        for (int r = 0; r < rangeCount; r++)
+        {
+            for (uint32_t e = rangeBegin[r]; e < rangeEnd[r]; e++)
+            {
+                float d = hypotf(soa.posX[i] - soa.gridPosX[e], soa.posY[i] - soa.gridPosY[e]);
+                if ((e != soa.gridSlot[i]) && (d > 0.0f)) closest = std::min(closest, d);
+            }
+        }
+    }
+    const SumColumn columns[] = {
+        { &BoidSoA::sepX, &BoidSoA::sepCount, 1.0f/closest }, { &BoidSoA::sepY, &BoidSoA::sepCount, 1.0f/closest },
+        { &BoidSoA::aliX, &BoidSoA::nearCount, boid.maxSpeed }, { &BoidSoA::aliY, &BoidSoA::nearCount, boid.maxSpeed },
+        { &BoidSoA::cohX, &BoidSoA::nearCount, WORLD }, { &BoidSoA::cohY, &BoidSoA::nearCount, WORLD },
+    };
+    std::span<float> BoidSoA::* const counts[] = { &BoidSoA::sepCount, &BoidSoA::nearCount };
+    std::span<float> BoidSoA::* const outputs[] = { &BoidSoA::accelX, &BoidSoA::accelY, &BoidSoA::newVelX, &BoidSoA::newVelY };
+
+    auto copyColumns = [&soa](auto& list)
+    {
+        std::vector<std::vector<float>> copy;
+        for (auto column : list) copy.emplace_back((soa.*column).begin(), (soa.*column).begin() + BOIDS);
+        return copy;
+    };
+
+    // Scalar reference
+    Accumulate(SimdLevel::Scalar, grid, soa, 0, BOIDS);
+    std::vector<std::vector<float>> scalarSums;
+    for (const SumColumn& column : columns) scalarSums.emplace_back((soa.*column.sum).begin(), (soa.*column.sum).begin() + BOIDS);
+    const std::vector<std::vector<float>> scalarCounts = copyColumns(counts);
+    Finalize(SimdLevel::Scalar, soa, weights, target, DT, 0, BOIDS);
+    const std::vector<std::vector<float>> scalarOutputs = copyColumns(outputs);
+
+    std::vector<SimdLevel> levels = { SimdLevel::Scalar };
+    SimdLevel best = DetectSimdLevel();
+    if ((best == SimdLevel::SSE) || (best == SimdLevel::AVX2)) levels.push_back(SimdLevel::SSE);
+    if ((best == SimdLevel::AVX2) || (best == SimdLevel::NEON)) levels.push_back(best);
+
+    bool passed = true;
+    for (SimdLevel level : levels)
+    {
+        double bestMs = 0.0;
+        for (int run = 0; run < RUNS; run++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            Accumulate(level, grid, soa, 0, BOIDS);
+            Finalize(level, soa, weights, target, DT, 0, BOIDS);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if ((run == 0) || (ms < bestMs)) bestMs = ms;
+        }
+
+        if (level == SimdLevel::Scalar)
+        {
+            std::cout << "Boid kernels Scalar: " << bestMs << " ms" << std::endl;
+            continue;
+        }
+
+        // Sum differences as a fraction of the rounding bound
+        bool countsMatch = (copyColumns(counts) == scalarCounts);
+        float sumError = 0.0f;
+        for (size_t c = 0; c < std::size(columns); c++)
+        {
+            const std::span<float>& sum = soa.*columns[c].sum;
+            const std::span<float>& count = soa.*columns[c].count;
+            for (size_t i = 0; i < BOIDS; i++)
+            {
+                float bound = std::max(count[i] - 1.0f, 0.0f)*count[i]*columns[c].term*FLT_EPSILON;
+                float difference = fabsf(sum[i] - scalarSums[c][i]);
+                if (difference > 0.0f) sumError = std::max(sumError, difference/bound);
+            }
+        }
+
+        // Finalize from the scalar sums
+        for (size_t c = 0; c < std::size(columns); c++) std::copy(scalarSums[c].begin(), scalarSums[c].end(), (soa.*columns[c].sum).begin());
+        Finalize(level, soa, weights, target, DT, 0, BOIDS);
+        float finalizeError = 0.0f;
+        for (size_t c = 0; c < std::size(outputs); c++)
+        {
+            float scale = (c < 2)? boid.maxForce : boid.maxSpeed;
+            for (size_t i = 0; i < BOIDS; i++)
+            {
+                finalizeError = std::max(finalizeError, fabsf((soa.*outputs[c])[i] - scalarOutputs[c][i])/scale);
+            }
+        }
+
+        bool matches = countsMatch && (sumError <= 1.0f) && (finalizeError <= FINALIZE_TOLERANCE);
+        passed = passed && matches;
+
+        std::cout << "Boid kernels " << GetSimdLevelName(level) << ": " << bestMs << " ms, neighbor counts "
+                  << (countsMatch? "match" : "differ") << ", sums off by " << sumError << " of the rounding bound, Finalize off by "
+                  << finalizeError << " relative" << (matches? "" : " FAILED") << std::endl;
+    }
+
+    std::cout << "Boid kernel self-check " << (passed? "passed" : "failed") << ": " << BOIDS << " boids (seed " << seed << ")" << std::endl;
+    return passed;
+}
+
+// Runs the headless benchmark once per thread count and reports ticks per second against one thread
+static bool RunThreadSweep(GameOptions options)
+{
+    size_t maxThreads = options.threads;
+    if (maxThreads == 0) maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    nlohmann::ordered_json runs = nlohmann::ordered_json::array();
+    double baseline = 0.0;
+    std::string checksum;
+    bool deterministic = true;
+    int boids = 0;
+
+    for (size_t threads : threadCounts)
+    {
+        options.threads = threads;
+        Game game(options);
+        if (!game.Initialize()) return false;
+
+        nlohmann::ordered_json report = game.RunBenchmark();
+        double ticksPerSecond = report["ticks_per_second"].get<double>();
+        if (threads == 1) baseline = ticksPerSecond;
+        boids = report["boids"].get<int>();
+
+        // Work is split the same way on any thread count, so the simulation must be too
+        if (checksum.empty()) checksum = report["checksum"].get<std::string>();
+        deterministic = deterministic && (report["checksum"].get<std::string>() == checksum);
+
+        runs.push_back({
+            {"threads", threads},
+            {"ticks_per_second", ticksPerSecond},
+            {"speedup", (baseline > 0.0)? ticksPerSecond/baseline : 0.0},
+            {"tick_ms_p50", report["tick_ms"]["p50"]},
+            {"checksum", report["checksum"]}
+        });
+    }
+
+    nlohmann::ordered_json sweep = {
+        {"ticks", options.ticks},
+        {"boids", boids},
+        {"hardware_threads", std::thread::hardware_concurrency()},
+        {"deterministic", deterministic},
+        {"runs", runs}
+    };
+
+    return WriteReport(sweep, options.reportPath) && deterministic;
+}
+
+int main(int argc, char* argv[])
+{
+    GameOptions options;
+    if (!ParseCommandLine(argc, argv, options))
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!options.microBenchmark.empty())
+    {
+        nlohmann::ordered_json report = RunMicroBenchmark(options.microBenchmark);
+        if (report.is_null())
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        return WriteReport(report, options.reportPath)? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.selfCheck)
+    {
+        unsigned int seed = options.seed? options.seed : 1;
+        bool passed = RunBroadPhaseSelfCheck(seed);
+        passed = RunBoidKernelSelfCheck(seed) && passed;
+        return passed? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (options.headless && options.threadSweep) return RunThreadSweep(options)? EXIT_SUCCESS : EXIT_FAILURE;
+
+    Game game(options);
     gameInstance = &game;
 
     // Initialize the game
@@ -28,6 +410,13 @@ int main(void)
         return EXIT_FAILURE;
     }
 
+    if (options.headless)
+    {
+        bool reported = game.RunHeadless();
+        game.Shutdown();
+        return reported? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     // Run the game loop
     #if defined(PLATFORM_WEB)
         emscripten_set_main_loop(MainLoop, 60, 1);
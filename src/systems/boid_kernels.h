@@ -0,0 +1,777 @@
+#pragma once
+
+#include "raylib.h"
+#include <algorithm>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cmath>
+#include "../utils/spatial_grid.h"
+#include "../utils/frame_arena.h"
+#include "../utils/simd.h"
+
+/*
+* Boid steering kernels over structure-of-arrays data, in a scalar version and
+* SSE, AVX2 and NEON versions. Steering runs in two stages:
+*  - Accumulate: per boid, sums separation, velocity and position over its
+*    neighbors. SIMD versions process 4 or 8 neighbors at a time from the
+*    grid-ordered copies, where every grid bucket is a contiguous range.
+*  - Finalize: per group of 4 or 8 boids, turns the sums into steering forces,
+*    integrates and clamps the velocity.
+*
+* The scalar kernels reproduce the reference math exactly. SIMD kernels do the
+* same operations per element (IEEE division and sqrt, no FMA on x86) but add
+* the neighbor sums up in a different order. Neighbor counts match exactly, the
+* sums match to within float rounding of adding them up, and Finalize gives the
+* scalar result from the same sums (--self-check checks all three). Most
+* accelerations differ by under 1e-6 relative, but cohesion subtracts the boid
+* position from an average of absolute positions, so a boid close to the center
+* of its neighbors has no bound on its cohesion direction error; in a 5600 unit
+* world a few per 20000 boids are off by 1e-3 to 1e-2 of maxForce. Trajectories
+* therefore drift apart over many ticks.
+*/
+namespace seecs
+{
+    namespace systems
+    {
+        namespace boid_system
+        {
+            // Behavior weights, each steering force is scaled by its weight before they're summed
+            struct BoidWeights
+            {
+                float separation = 1.5f;
+                float alignment = 1.0f;
+                float cohesion = 1.0f;
+                float target = 1.2f; // Pull towards the mouse or scripted target
+            };
+
+            // Widest kernel, every per-boid array is padded to a multiple of it
+            constexpr size_t KERNEL_WIDTH = 8;
+
+            // Per-boid columns, carved out of a FrameArena every tick by Allocate()
+            struct BoidSoA
+            {
+                // Gathered inputs, in gather order
+                std::span<float> posX, posY;
+                std::span<float> velX, velY;
+                std::span<float> maxSpeed, maxForce;
+                std::span<float> separationRadius, neighborRadius;
+
+                // Positions and velocities in grid entry order, for neighbor loads
+                std::span<float> gridPosX, gridPosY;
+                std::span<float> gridVelX, gridVelY;
+                std::span<uint32_t> gridSlot; // Grid entry of every boid, to skip itself
+
+                // Neighbor sums
+                std::span<float> sepX, sepY, sepCount;
+                std::span<float> aliX, aliY;
+                std::span<float> cohX, cohY, nearCount;
+
+                // Outputs
+                std::span<float> accelX, accelY;
+                std::span<float> newVelX, newVelY;
+
+                // Sizes every column for up to capacity boids, the columns
+                // stay valid until the arena is reset
+                void Allocate(FrameArena& arena, size_t capacity)
+                {
+                    size_t padded = (capacity + KERNEL_WIDTH - 1)/KERNEL_WIDTH*KERNEL_WIDTH;
+
+                    for (std::span<float>* column : { &posX, &posY, &velX, &velY, &maxSpeed, &maxForce, &separationRadius, &neighborRadius,
+                                                      &sepX, &sepY, &sepCount, &aliX, &aliY, &cohX, &cohY, &nearCount,
+                                                      &accelX, &accelY, &newVelX, &newVelY })
+                    {
+                        *column = arena.AllocateArray<float>(padded);
+                    }
+
+                    // Neighbor loads may run up to a full vector past the last entry
+                    for (std::span<float>* column : { &gridPosX, &gridPosY, &gridVelX, &gridVelY })
+                    {
+                        *column = arena.AllocateArray<float>(capacity + KERNEL_WIDTH);
+                    }
+                    gridSlot = arena.AllocateArray<uint32_t>(capacity);
+                }
+
+                // Zeroes the padding lanes past the count gathered boids.
+                // Padding lanes are computed but never read back.
+                void Pad(size_t count)
+                {
+                    size_t padded = (count + KERNEL_WIDTH - 1)/KERNEL_WIDTH*KERNEL_WIDTH;
+
+                    for (std::span<float>* column : { &posX, &posY, &velX, &velY, &maxSpeed, &maxForce, &separationRadius, &neighborRadius })
+                    {
+                        std::fill(column->begin() + count, column->begin() + padded, 0.0f);
+                    }
+                    for (std::span<float>* column : { &gridPosX, &gridPosY, &gridVelX, &gridVelY })
+                    {
+                        std::fill(column->begin() + count, column->begin() + count + KERNEL_WIDTH, 0.0f);
+                    }
+                }
+
+                // Copies positions and velocities into grid entry order
+                void SortByGrid(const SpatialHashGrid& grid)
+                {
+                    const std::vector<uint32_t>& entries = grid.GetEntries();
+                    for (size_t e = 0; e < entries.size(); e++)
+                    {
+                        uint32_t i = entries[e];
+                        gridPosX[e] = posX[i];
+                        gridPosY[e] = posY[i];
+                        gridVelX[e] = velX[i];
+                        gridVelY[e] = velY[i];
+                        gridSlot[i] = (uint32_t)e;
+                    }
+                }
+            };
+
+            // Turns a desired direction into a steering force: desired is scaled to
+            // maxSpeed, the current velocity is subtracted and the result is clamped to maxForce
+            inline Vector2 Steer(Vector2 desired, float length, Vector2 vel, float maxSpeed, float maxForce)
+            {
+                Vector2 steer = {
+                    (desired.x / length) * maxSpeed - vel.x, // Manual Vector2Normalize, Vector2Scale and Vector2Subtract
+                    (desired.y / length) * maxSpeed - vel.y
+                };
+
+                float steerLength = sqrtf(steer.x * steer.x + steer.y * steer.y);
+                if (steerLength > maxForce)
+                {
+                    steer.x = (steer.x / steerLength) * maxForce;
+                    steer.y = (steer.y / steerLength) * maxForce;
+                }
+
+                return steer;
+            }
+
+            // Scalar kernels
+
+            // Neighbor sums for boid i over the given ranges of grid entries
+            inline void AccumulateRangesScalar(BoidSoA& soa, size_t i, const uint32_t* rangeBegin, const uint32_t* rangeEnd, int rangeCount)
+            {
+                const float px = soa.posX[i], py = soa.posY[i];
+                const float separationRadius = soa.separationRadius[i], neighborRadius = soa.neighborRadius[i];
+                const uint32_t self = soa.gridSlot[i];
+
+                float sepX = 0, sepY = 0, aliX = 0, aliY = 0, cohX = 0, cohY = 0;
+                int sepCount = 0, nearCount = 0;
+
+                for (int r = 0; r < rangeCount; r++)
+                {
+                    for (uint32_t e = rangeBegin[r]; e < rangeEnd[r]; e++)
+                    {
+                        if (e == self) continue;
+
+                        float dx = px - soa.gridPosX[e];
+                        float dy = py - soa.gridPosY[e];
+                        float d = sqrtf(dx * dx + dy * dy); // Manual Vector2Distance
+
+                        if (d < separationRadius && d > 0)
+                        {
+                            sepX += (dx / d) * (1.0f / d); // Manual Vector2Normalize and Vector2Scale
+                            sepY += (dy / d) * (1.0f / d);
+                            sepCount++;
+                        }
+
+                        if (d < neighborRadius)
+                        {
+                            aliX += soa.gridVelX[e];
+                            aliY += soa.gridVelY[e];
+                            cohX += soa.gridPosX[e];
+                            cohY += soa.gridPosY[e];
+                            nearCount++;
+                        }
+                    }
+                }
+
+                soa.sepX[i] = sepX; soa.sepY[i] = sepY; soa.sepCount[i] = (float)sepCount;
+                soa.aliX[i] = aliX; soa.aliY[i] = aliY;
+                soa.cohX[i] = cohX; soa.cohY[i] = cohY; soa.nearCount[i] = (float)nearCount;
+            }
+
+            inline void AccumulateScalar(const SpatialHashGrid& grid, BoidSoA& soa, size_t begin, size_t end)
+            {
+                uint32_t rangeBegin[9], rangeEnd[9];
+
+                for (size_t i = begin; i < end; i++)
+                {
+                    int rangeCount = grid.GetNearRanges({soa.posX[i], soa.posY[i]}, rangeBegin, rangeEnd);
+                    AccumulateRangesScalar(soa, i, rangeBegin, rangeEnd, rangeCount);
+                }
+            }
+
+            // O(N^2) reference for the grid: every boid is tested against all count
+            // boids instead of the 3x3 cells around it. It finds the same neighbors
+            // as AccumulateScalar but adds them up in a different order.
+            inline void AccumulateBruteForce(BoidSoA& soa, size_t count, size_t begin, size_t end)
+            {
+                const uint32_t rangeBegin = 0, rangeEnd = (uint32_t)count;
+
+                for (size_t i = begin; i < end; i++)
+                {
+                    AccumulateRangesScalar(soa, i, &rangeBegin, &rangeEnd, 1);
+                }
+            }
+
+            inline void FinalizeScalar(BoidSoA& soa, BoidWeights weights, Vector2 mouse, float deltaTime, size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    const Vector2 pos = {soa.posX[i], soa.posY[i]};
+                    const Vector2 vel = {soa.velX[i], soa.velY[i]};
+                    const float maxSpeed = soa.maxSpeed[i], maxForce = soa.maxForce[i];
+
+                    Vector2 steerToMouse = {mouse.x - pos.x, mouse.y - pos.y}; // Manual Vector2Subtract
+                    float distToMouse = sqrtf(steerToMouse.x * steerToMouse.x + steerToMouse.y * steerToMouse.y); // Manual Vector2Length
+                    steerToMouse = (distToMouse > 1.0f)? Steer(steerToMouse, distToMouse, vel, maxSpeed, maxForce) : Vector2{0, 0};
+
+                    Vector2 sep = {soa.sepX[i], soa.sepY[i]};
+                    Vector2 ali = {soa.aliX[i], soa.aliY[i]};
+                    Vector2 coh = {soa.cohX[i], soa.cohY[i]};
+                    const float sepCount = soa.sepCount[i], nearCount = soa.nearCount[i];
+
+                    if (sepCount > 0)
+                    {
+                        sep.x /= sepCount; // Manual Vector2Scale
+                        sep.y /= sepCount;
+                    }
+
+                    if (nearCount > 0)
+                    {
+                        ali.x /= nearCount; // Manual Vector2Scale
+                        ali.y /= nearCount;
+                        coh.x /= nearCount;
+                        coh.y /= nearCount;
+                        coh.x -= pos.x; // Manual Vector2Subtract
+                        coh.y -= pos.y;
+                    }
+
+                    // Steering for alignment, cohesion and separation
+                    float aliLength = sqrtf(ali.x * ali.x + ali.y * ali.y);
+                    if (aliLength > 0) ali = Steer(ali, aliLength, vel, maxSpeed, maxForce);
+
+                    float cohLength = sqrtf(coh.x * coh.x + coh.y * coh.y);
+                    if (cohLength > 0) coh = Steer(coh, cohLength, vel, maxSpeed, maxForce);
+
+                    float sepLength = sqrtf(sep.x * sep.x + sep.y * sep.y);
+                    if (sepLength > 0) sep = Steer(sep, sepLength, vel, maxSpeed, maxForce);
+
+                    Vector2 accel = {0, 0};
+                    accel.x += sep.x * weights.separation; // Manual Vector2Add and Vector2Scale
+                    accel.y += sep.y * weights.separation;
+                    accel.x += ali.x * weights.alignment;
+                    accel.y += ali.y * weights.alignment;
+                    accel.x += coh.x * weights.cohesion;
+                    accel.y += coh.y * weights.cohesion;
+                    accel.x += steerToMouse.x * weights.target;
+                    accel.y += steerToMouse.y * weights.target;
+
+                    // Clamp velocity
+                    Vector2 newVel = {
+                        vel.x + accel.x * deltaTime, // Manual Vector2Add and Vector2Scale
+                        vel.y + accel.y * deltaTime
+                    };
+
+                    float velLength = sqrtf(newVel.x * newVel.x + newVel.y * newVel.y);
+                    if (velLength > maxSpeed)
+                    {
+                        newVel.x = (newVel.x / velLength) * maxSpeed; // Manual Vector2Normalize and Vector2Scale
+                        newVel.y = (newVel.y / velLength) * maxSpeed;
+                    }
+
+                    soa.accelX[i] = accel.x; soa.accelY[i] = accel.y;
+                    soa.newVelX[i] = newVel.x; soa.newVelY[i] = newVel.y;
+                }
+            }
+
+#if defined(SIMD_HAS_SSE)
+            // SSE kernels, 4 lanes
+
+            inline float SumSSE(__m128 v)
+            {
+                __m128 high = _mm_movehl_ps(v, v);
+                v = _mm_add_ps(v, high);
+                v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+                return _mm_cvtss_f32(v);
+            }
+
+            inline __m128 SelectSSE(__m128 mask, __m128 a, __m128 b)
+            {
+                return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+            }
+
+            inline void SteerSSE(__m128& x, __m128& y, __m128 length, __m128 velX, __m128 velY, __m128 maxSpeed, __m128 maxForce)
+            {
+                __m128 sx = _mm_sub_ps(_mm_mul_ps(_mm_div_ps(x, length), maxSpeed), velX);
+                __m128 sy = _mm_sub_ps(_mm_mul_ps(_mm_div_ps(y, length), maxSpeed), velY);
+                __m128 steerLength = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(sx, sx), _mm_mul_ps(sy, sy)));
+                __m128 clamp = _mm_cmpgt_ps(steerLength, maxForce);
+                x = SelectSSE(clamp, _mm_mul_ps(_mm_div_ps(sx, steerLength), maxForce), sx);
+                y = SelectSSE(clamp, _mm_mul_ps(_mm_div_ps(sy, steerLength), maxForce), sy);
+            }
+
+            inline void AccumulateSSE(const SpatialHashGrid& grid, BoidSoA& soa, size_t begin, size_t end)
+            {
+                const __m128i lane = _mm_setr_epi32(0, 1, 2, 3);
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 one = _mm_set1_ps(1.0f);
+                uint32_t rangeBegin[9], rangeEnd[9];
+
+                for (size_t i = begin; i < end; i++)
+                {
+                    const __m128 px = _mm_set1_ps(soa.posX[i]);
+                    const __m128 py = _mm_set1_ps(soa.posY[i]);
+                    const __m128 separationRadius = _mm_set1_ps(soa.separationRadius[i]);
+                    const __m128 neighborRadius = _mm_set1_ps(soa.neighborRadius[i]);
+                    const __m128i self = _mm_set1_epi32((int)soa.gridSlot[i]);
+
+                    __m128 sepX = zero, sepY = zero, sepCount = zero;
+                    __m128 aliX = zero, aliY = zero, cohX = zero, cohY = zero, nearCount = zero;
+
+                    int rangeCount = grid.GetNearRanges({soa.posX[i], soa.posY[i]}, rangeBegin, rangeEnd);
+                    for (int r = 0; r < rangeCount; r++)
+                    {
+                        const __m128i last = _mm_set1_epi32((int)rangeEnd[r]);
+                        for (uint32_t e = rangeBegin[r]; e < rangeEnd[r]; e += 4)
+                        {
+                            // Lanes past the range end or on the boid itself don't count
+                            __m128i index = _mm_add_epi32(_mm_set1_epi32((int)e), lane);
+                            __m128 valid = _mm_castsi128_ps(_mm_andnot_si128(_mm_cmpeq_epi32(index, self), _mm_cmplt_epi32(index, last)));
+
+                            __m128 ox = _mm_loadu_ps(&soa.gridPosX[e]);
+                            __m128 oy = _mm_loadu_ps(&soa.gridPosY[e]);
+                            __m128 dx = _mm_sub_ps(px, ox);
+                            __m128 dy = _mm_sub_ps(py, oy);
+                            __m128 d = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+                            __m128 separate = _mm_and_ps(valid, _mm_and_ps(_mm_cmplt_ps(d, separationRadius), _mm_cmpgt_ps(d, zero)));
+                            __m128 invD = _mm_div_ps(one, d);
+                            sepX = _mm_add_ps(sepX, _mm_and_ps(separate, _mm_mul_ps(_mm_div_ps(dx, d), invD)));
+                            sepY = _mm_add_ps(sepY, _mm_and_ps(separate, _mm_mul_ps(_mm_div_ps(dy, d), invD)));
+                            sepCount = _mm_add_ps(sepCount, _mm_and_ps(separate, one));
+
+                            __m128 neighbor = _mm_and_ps(valid, _mm_cmplt_ps(d, neighborRadius));
+                            aliX = _mm_add_ps(aliX, _mm_and_ps(neighbor, _mm_loadu_ps(&soa.gridVelX[e])));
+                            aliY = _mm_add_ps(aliY, _mm_and_ps(neighbor, _mm_loadu_ps(&soa.gridVelY[e])));
+                            cohX = _mm_add_ps(cohX, _mm_and_ps(neighbor, ox));
+                            cohY = _mm_add_ps(cohY, _mm_and_ps(neighbor, oy));
+                            nearCount = _mm_add_ps(nearCount, _mm_and_ps(neighbor, one));
+                        }
+                    }
+
+                    soa.sepX[i] = SumSSE(sepX); soa.sepY[i] = SumSSE(sepY); soa.sepCount[i] = SumSSE(sepCount);
+                    soa.aliX[i] = SumSSE(aliX); soa.aliY[i] = SumSSE(aliY);
+                    soa.cohX[i] = SumSSE(cohX); soa.cohY[i] = SumSSE(cohY); soa.nearCount[i] = SumSSE(nearCount);
+                }
+            }
+
+            inline void FinalizeSSE(BoidSoA& soa, BoidWeights weights, Vector2 mouse, float deltaTime, size_t begin, size_t end)
+            {
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 one = _mm_set1_ps(1.0f);
+                const __m128 mouseX = _mm_set1_ps(mouse.x);
+                const __m128 mouseY = _mm_set1_ps(mouse.y);
+                const __m128 dt = _mm_set1_ps(deltaTime);
+
+                for (size_t i = begin; i < end; i += 4)
+                {
+                    const __m128 px = _mm_loadu_ps(&soa.posX[i]), py = _mm_loadu_ps(&soa.posY[i]);
+                    const __m128 vx = _mm_loadu_ps(&soa.velX[i]), vy = _mm_loadu_ps(&soa.velY[i]);
+                    const __m128 maxSpeed = _mm_loadu_ps(&soa.maxSpeed[i]), maxForce = _mm_loadu_ps(&soa.maxForce[i]);
+
+                    __m128 mx = _mm_sub_ps(mouseX, px);
+                    __m128 my = _mm_sub_ps(mouseY, py);
+                    __m128 distToMouse = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(mx, mx), _mm_mul_ps(my, my)));
+                    __m128 followMouse = _mm_cmpgt_ps(distToMouse, one);
+                    SteerSSE(mx, my, distToMouse, vx, vy, maxSpeed, maxForce);
+                    mx = _mm_and_ps(followMouse, mx);
+                    my = _mm_and_ps(followMouse, my);
+
+                    __m128 sepX = _mm_loadu_ps(&soa.sepX[i]), sepY = _mm_loadu_ps(&soa.sepY[i]);
+                    __m128 aliX = _mm_loadu_ps(&soa.aliX[i]), aliY = _mm_loadu_ps(&soa.aliY[i]);
+                    __m128 cohX = _mm_loadu_ps(&soa.cohX[i]), cohY = _mm_loadu_ps(&soa.cohY[i]);
+                    __m128 sepCount = _mm_loadu_ps(&soa.sepCount[i]), nearCount = _mm_loadu_ps(&soa.nearCount[i]);
+
+                    __m128 anySep = _mm_cmpgt_ps(sepCount, zero);
+                    sepX = SelectSSE(anySep, _mm_div_ps(sepX, sepCount), sepX);
+                    sepY = SelectSSE(anySep, _mm_div_ps(sepY, sepCount), sepY);
+
+                    __m128 anyNear = _mm_cmpgt_ps(nearCount, zero);
+                    aliX = SelectSSE(anyNear, _mm_div_ps(aliX, nearCount), aliX);
+                    aliY = SelectSSE(anyNear, _mm_div_ps(aliY, nearCount), aliY);
+                    cohX = SelectSSE(anyNear, _mm_sub_ps(_mm_div_ps(cohX, nearCount), px), cohX);
+                    cohY = SelectSSE(anyNear, _mm_sub_ps(_mm_div_ps(cohY, nearCount), py), cohY);
+
+                    __m128* forces[3][2] = { { &aliX, &aliY }, { &cohX, &cohY }, { &sepX, &sepY } };
+                    for (auto& force : forces)
+                    {
+                        __m128 x = *force[0], y = *force[1];
+                        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+                        __m128 steer = _mm_cmpgt_ps(length, zero);
+                        SteerSSE(x, y, length, vx, vy, maxSpeed, maxForce);
+                        *force[0] = SelectSSE(steer, x, *force[0]);
+                        *force[1] = SelectSSE(steer, y, *force[1]);
+                    }
+
+                    __m128 ax = _mm_add_ps(zero, _mm_mul_ps(sepX, _mm_set1_ps(weights.separation)));
+                    __m128 ay = _mm_add_ps(zero, _mm_mul_ps(sepY, _mm_set1_ps(weights.separation)));
+                    ax = _mm_add_ps(ax, _mm_mul_ps(aliX, _mm_set1_ps(weights.alignment)));
+                    ay = _mm_add_ps(ay, _mm_mul_ps(aliY, _mm_set1_ps(weights.alignment)));
+                    ax = _mm_add_ps(ax, _mm_mul_ps(cohX, _mm_set1_ps(weights.cohesion)));
+                    ay = _mm_add_ps(ay, _mm_mul_ps(cohY, _mm_set1_ps(weights.cohesion)));
+                    ax = _mm_add_ps(ax, _mm_mul_ps(mx, _mm_set1_ps(weights.target)));
+                    ay = _mm_add_ps(ay, _mm_mul_ps(my, _mm_set1_ps(weights.target)));
+
+                    // Clamp velocity
+                    __m128 nvx = _mm_add_ps(vx, _mm_mul_ps(ax, dt));
+                    __m128 nvy = _mm_add_ps(vy, _mm_mul_ps(ay, dt));
+                    __m128 velLength = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(nvx, nvx), _mm_mul_ps(nvy, nvy)));
+                    __m128 clamp = _mm_cmpgt_ps(velLength, maxSpeed);
+                    nvx = SelectSSE(clamp, _mm_mul_ps(_mm_div_ps(nvx, velLength), maxSpeed), nvx);
+                    nvy = SelectSSE(clamp, _mm_mul_ps(_mm_div_ps(nvy, velLength), maxSpeed), nvy);
+
+                    _mm_storeu_ps(&soa.accelX[i], ax); _mm_storeu_ps(&soa.accelY[i], ay);
+                    _mm_storeu_ps(&soa.newVelX[i], nvx); _mm_storeu_ps(&soa.newVelY[i], nvy);
+                }
+            }
+#endif
+
+#if defined(SIMD_HAS_AVX2)
+            // AVX2 kernels, 8 lanes. Compiled for AVX2 per function and only
+            // called after DetectSimdLevel() has found it.
+
+            SIMD_TARGET_AVX2 inline float SumAVX2(__m256 v)
+            {
+                __m128 low = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+                __m128 high = _mm_movehl_ps(low, low);
+                low = _mm_add_ps(low, high);
+                low = _mm_add_ss(low, _mm_shuffle_ps(low, low, 1));
+                return _mm_cvtss_f32(low);
+            }
+
+            SIMD_TARGET_AVX2 inline void SteerAVX2(__m256& x, __m256& y, __m256 length, __m256 velX, __m256 velY, __m256 maxSpeed, __m256 maxForce)
+            {
+                __m256 sx = _mm256_sub_ps(_mm256_mul_ps(_mm256_div_ps(x, length), maxSpeed), velX);
+                __m256 sy = _mm256_sub_ps(_mm256_mul_ps(_mm256_div_ps(y, length), maxSpeed), velY);
+                __m256 steerLength = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(sx, sx), _mm256_mul_ps(sy, sy)));
+                __m256 clamp = _mm256_cmp_ps(steerLength, maxForce, _CMP_GT_OQ);
+                x = _mm256_blendv_ps(sx, _mm256_mul_ps(_mm256_div_ps(sx, steerLength), maxForce), clamp);
+                y = _mm256_blendv_ps(sy, _mm256_mul_ps(_mm256_div_ps(sy, steerLength), maxForce), clamp);
+            }
+
+            SIMD_TARGET_AVX2 inline void AccumulateAVX2(const SpatialHashGrid& grid, BoidSoA& soa, size_t begin, size_t end)
+            {
+                const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 one = _mm256_set1_ps(1.0f);
+                uint32_t rangeBegin[9], rangeEnd[9];
+
+                for (size_t i = begin; i < end; i++)
+                {
+                    const __m256 px = _mm256_set1_ps(soa.posX[i]);
+                    const __m256 py = _mm256_set1_ps(soa.posY[i]);
+                    const __m256 separationRadius = _mm256_set1_ps(soa.separationRadius[i]);
+                    const __m256 neighborRadius = _mm256_set1_ps(soa.neighborRadius[i]);
+                    const __m256i self = _mm256_set1_epi32((int)soa.gridSlot[i]);
+
+                    __m256 sepX = zero, sepY = zero, sepCount = zero;
+                    __m256 aliX = zero, aliY = zero, cohX = zero, cohY = zero, nearCount = zero;
+
+                    int rangeCount = grid.GetNearRanges({soa.posX[i], soa.posY[i]}, rangeBegin, rangeEnd);
+                    for (int r = 0; r < rangeCount; r++)
+                    {
+                        const __m256i last = _mm256_set1_epi32((int)rangeEnd[r]);
+                        for (uint32_t e = rangeBegin[r]; e < rangeEnd[r]; e += 8)
+                        {
+                            // Lanes past the range end or on the boid itself don't count
+                            __m256i index = _mm256_add_epi32(_mm256_set1_epi32((int)e), lane);
+                            __m256 valid = _mm256_castsi256_ps(_mm256_andnot_si256(_mm256_cmpeq_epi32(index, self), _mm256_cmpgt_epi32(last, index)));
+
+                            __m256 ox = _mm256_loadu_ps(&soa.gridPosX[e]);
+                            __m256 oy = _mm256_loadu_ps(&soa.gridPosY[e]);
+                            __m256 dx = _mm256_sub_ps(px, ox);
+                            __m256 dy = _mm256_sub_ps(py, oy);
+                            __m256 d = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+
+                            __m256 separate = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(d, separationRadius, _CMP_LT_OQ), _mm256_cmp_ps(d, zero, _CMP_GT_OQ)));
+                            __m256 invD = _mm256_div_ps(one, d);
+                            sepX = _mm256_add_ps(sepX, _mm256_and_ps(separate, _mm256_mul_ps(_mm256_div_ps(dx, d), invD)));
+                            sepY = _mm256_add_ps(sepY, _mm256_and_ps(separate, _mm256_mul_ps(_mm256_div_ps(dy, d), invD)));
+                            sepCount = _mm256_add_ps(sepCount, _mm256_and_ps(separate, one));
+
+                            __m256 neighbor = _mm256_and_ps(valid, _mm256_cmp_ps(d, neighborRadius, _CMP_LT_OQ));
+                            aliX = _mm256_add_ps(aliX, _mm256_and_ps(neighbor, _mm256_loadu_ps(&soa.gridVelX[e])));
+                            aliY = _mm256_add_ps(aliY, _mm256_and_ps(neighbor, _mm256_loadu_ps(&soa.gridVelY[e])));
+                            cohX = _mm256_add_ps(cohX, _mm256_and_ps(neighbor, ox));
+                            cohY = _mm256_add_ps(cohY, _mm256_and_ps(neighbor, oy));
+                            nearCount = _mm256_add_ps(nearCount, _mm256_and_ps(neighbor, one));
+                        }
+                    }
+
+                    soa.sepX[i] = SumAVX2(sepX); soa.sepY[i] = SumAVX2(sepY); soa.sepCount[i] = SumAVX2(sepCount);
+                    soa.aliX[i] = SumAVX2(aliX); soa.aliY[i] = SumAVX2(aliY);
+                    soa.cohX[i] = SumAVX2(cohX); soa.cohY[i] = SumAVX2(cohY); soa.nearCount[i] = SumAVX2(nearCount);
+                }
+            }
+
+            SIMD_TARGET_AVX2 inline void FinalizeAVX2(BoidSoA& soa, BoidWeights weights, Vector2 mouse, float deltaTime, size_t begin, size_t end)
+            {
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 one = _mm256_set1_ps(1.0f);
+                const __m256 mouseX = _mm256_set1_ps(mouse.x);
+                const __m256 mouseY = _mm256_set1_ps(mouse.y);
+                const __m256 dt = _mm256_set1_ps(deltaTime);
+
+                for (size_t i = begin; i < end; i += 8)
+                {
+                    const __m256 px = _mm256_loadu_ps(&soa.posX[i]), py = _mm256_loadu_ps(&soa.posY[i]);
+                    const __m256 vx = _mm256_loadu_ps(&soa.velX[i]), vy = _mm256_loadu_ps(&soa.velY[i]);
+                    const __m256 maxSpeed = _mm256_loadu_ps(&soa.maxSpeed[i]), maxForce = _mm256_loadu_ps(&soa.maxForce[i]);
+
+                    __m256 mx = _mm256_sub_ps(mouseX, px);
+                    __m256 my = _mm256_sub_ps(mouseY, py);
+                    __m256 distToMouse = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(mx, mx), _mm256_mul_ps(my, my)));
+                    __m256 followMouse = _mm256_cmp_ps(distToMouse, one, _CMP_GT_OQ);
+                    SteerAVX2(mx, my, distToMouse, vx, vy, maxSpeed, maxForce);
+                    mx = _mm256_and_ps(followMouse, mx);
+                    my = _mm256_and_ps(followMouse, my);
+
+                    __m256 sepX = _mm256_loadu_ps(&soa.sepX[i]), sepY = _mm256_loadu_ps(&soa.sepY[i]);
+                    __m256 aliX = _mm256_loadu_ps(&soa.aliX[i]), aliY = _mm256_loadu_ps(&soa.aliY[i]);
+                    __m256 cohX = _mm256_loadu_ps(&soa.cohX[i]), cohY = _mm256_loadu_ps(&soa.cohY[i]);
+                    __m256 sepCount = _mm256_loadu_ps(&soa.sepCount[i]), nearCount = _mm256_loadu_ps(&soa.nearCount[i]);
+
+                    __m256 anySep = _mm256_cmp_ps(sepCount, zero, _CMP_GT_OQ);
+                    sepX = _mm256_blendv_ps(sepX, _mm256_div_ps(sepX, sepCount), anySep);
+                    sepY = _mm256_blendv_ps(sepY, _mm256_div_ps(sepY, sepCount), anySep);
+
+                    __m256 anyNear = _mm256_cmp_ps(nearCount, zero, _CMP_GT_OQ);
+                    aliX = _mm256_blendv_ps(aliX, _mm256_div_ps(aliX, nearCount), anyNear);
+                    aliY = _mm256_blendv_ps(aliY, _mm256_div_ps(aliY, nearCount), anyNear);
+                    cohX = _mm256_blendv_ps(cohX, _mm256_sub_ps(_mm256_div_ps(cohX, nearCount), px), anyNear);
+                    cohY = _mm256_blendv_ps(cohY, _mm256_sub_ps(_mm256_div_ps(cohY, nearCount), py), anyNear);
+
+                    __m256* forces[3][2] = { { &aliX, &aliY }, { &cohX, &cohY }, { &sepX, &sepY } };
+                    for (int f = 0; f < 3; f++)
+                    {
+                        __m256 x = *forces[f][0], y = *forces[f][1];
+                        __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+                        __m256 steer = _mm256_cmp_ps(length, zero, _CMP_GT_OQ);
+                        SteerAVX2(x, y, length, vx, vy, maxSpeed, maxForce);
+                        *forces[f][0] = _mm256_blendv_ps(*forces[f][0], x, steer);
+                        *forces[f][1] = _mm256_blendv_ps(*forces[f][1], y, steer);
+                    }
+
+                    __m256 ax = _mm256_add_ps(zero, _mm256_mul_ps(sepX, _mm256_set1_ps(weights.separation)));
+                    __m256 ay = _mm256_add_ps(zero, _mm256_mul_ps(sepY, _mm256_set1_ps(weights.separation)));
+                    ax = _mm256_add_ps(ax, _mm256_mul_ps(aliX, _mm256_set1_ps(weights.alignment)));
+                    ay = _mm256_add_ps(ay, _mm256_mul_ps(aliY, _mm256_set1_ps(weights.alignment)));
+                    ax = _mm256_add_ps(ax, _mm256_mul_ps(cohX, _mm256_set1_ps(weights.cohesion)));
+                    ay = _mm256_add_ps(ay, _mm256_mul_ps(cohY, _mm256_set1_ps(weights.cohesion)));
+                    ax = _mm256_add_ps(ax, _mm256_mul_ps(mx, _mm256_set1_ps(weights.target)));
+                    ay = _mm256_add_ps(ay, _mm256_mul_ps(my, _mm256_set1_ps(weights.target)));
+
+                    // Clamp velocity
+                    __m256 nvx = _mm256_add_ps(vx, _mm256_mul_ps(ax, dt));
+                    __m256 nvy = _mm256_add_ps(vy, _mm256_mul_ps(ay, dt));
+                    __m256 velLength = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(nvx, nvx), _mm256_mul_ps(nvy, nvy)));
+                    __m256 clamp = _mm256_cmp_ps(velLength, maxSpeed, _CMP_GT_OQ);
+                    nvx = _mm256_blendv_ps(nvx, _mm256_mul_ps(_mm256_div_ps(nvx, velLength), maxSpeed), clamp);
+                    nvy = _mm256_blendv_ps(nvy, _mm256_mul_ps(_mm256_div_ps(nvy, velLength), maxSpeed), clamp);
+
+                    _mm256_storeu_ps(&soa.accelX[i], ax); _mm256_storeu_ps(&soa.accelY[i], ay);
+                    _mm256_storeu_ps(&soa.newVelX[i], nvx); _mm256_storeu_ps(&soa.newVelY[i], nvy);
+                }
+            }
+#endif
+
+#if defined(SIMD_HAS_NEON)
+            // NEON kernels, 4 lanes
+
+            inline void SteerNEON(float32x4_t& x, float32x4_t& y, float32x4_t length, float32x4_t velX, float32x4_t velY, float32x4_t maxSpeed, float32x4_t maxForce)
+            {
+                float32x4_t sx = vsubq_f32(vmulq_f32(vdivq_f32(x, length), maxSpeed), velX);
+                float32x4_t sy = vsubq_f32(vmulq_f32(vdivq_f32(y, length), maxSpeed), velY);
+                float32x4_t steerLength = vsqrtq_f32(vaddq_f32(vmulq_f32(sx, sx), vmulq_f32(sy, sy)));
+                uint32x4_t clamp = vcgtq_f32(steerLength, maxForce);
+                x = vbslq_f32(clamp, vmulq_f32(vdivq_f32(sx, steerLength), maxForce), sx);
+                y = vbslq_f32(clamp, vmulq_f32(vdivq_f32(sy, steerLength), maxForce), sy);
+            }
+
+            // Keeps value where mask is set, +0 elsewhere
+            inline float32x4_t MaskNEON(uint32x4_t mask, float32x4_t value)
+            {
+                return vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(value)));
+            }
+
+            inline void AccumulateNEON(const SpatialHashGrid& grid, BoidSoA& soa, size_t begin, size_t end)
+            {
+                const uint32_t laneValues[4] = { 0, 1, 2, 3 };
+                const uint32x4_t lane = vld1q_u32(laneValues);
+                const float32x4_t zero = vdupq_n_f32(0.0f);
+                const float32x4_t one = vdupq_n_f32(1.0f);
+                uint32_t rangeBegin[9], rangeEnd[9];
+
+                for (size_t i = begin; i < end; i++)
+                {
+                    const float32x4_t px = vdupq_n_f32(soa.posX[i]);
+                    const float32x4_t py = vdupq_n_f32(soa.posY[i]);
+                    const float32x4_t separationRadius = vdupq_n_f32(soa.separationRadius[i]);
+                    const float32x4_t neighborRadius = vdupq_n_f32(soa.neighborRadius[i]);
+                    const uint32x4_t self = vdupq_n_u32(soa.gridSlot[i]);
+
+                    float32x4_t sepX = zero, sepY = zero, sepCount = zero;
+                    float32x4_t aliX = zero, aliY = zero, cohX = zero, cohY = zero, nearCount = zero;
+
+                    int rangeCount = grid.GetNearRanges({soa.posX[i], soa.posY[i]}, rangeBegin, rangeEnd);
+                    for (int r = 0; r < rangeCount; r++)
+                    {
+                        const uint32x4_t last = vdupq_n_u32(rangeEnd[r]);
+                        for (uint32_t e = rangeBegin[r]; e < rangeEnd[r]; e += 4)
+                        {
+                            // Lanes past the range end or on the boid itself don't count
+                            uint32x4_t index = vaddq_u32(vdupq_n_u32(e), lane);
+                            uint32x4_t valid = vandq_u32(vmvnq_u32(vceqq_u32(index, self)), vcltq_u32(index, last));
+
+                            float32x4_t ox = vld1q_f32(&soa.gridPosX[e]);
+                            float32x4_t oy = vld1q_f32(&soa.gridPosY[e]);
+                            float32x4_t dx = vsubq_f32(px, ox);
+                            float32x4_t dy = vsubq_f32(py, oy);
+                            float32x4_t d = vsqrtq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)));
+
+                            uint32x4_t separate = vandq_u32(valid, vandq_u32(vcltq_f32(d, separationRadius), vcgtq_f32(d, zero)));
+                            float32x4_t invD = vdivq_f32(one, d);
+                            sepX = vaddq_f32(sepX, MaskNEON(separate, vmulq_f32(vdivq_f32(dx, d), invD)));
+                            sepY = vaddq_f32(sepY, MaskNEON(separate, vmulq_f32(vdivq_f32(dy, d), invD)));
+                            sepCount = vaddq_f32(sepCount, MaskNEON(separate, one));
+
+                            uint32x4_t neighbor = vandq_u32(valid, vcltq_f32(d, neighborRadius));
+                            aliX = vaddq_f32(aliX, MaskNEON(neighbor, vld1q_f32(&soa.gridVelX[e])));
+                            aliY = vaddq_f32(aliY, MaskNEON(neighbor, vld1q_f32(&soa.gridVelY[e])));
+                            cohX = vaddq_f32(cohX, MaskNEON(neighbor, ox));
+                            cohY = vaddq_f32(cohY, MaskNEON(neighbor, oy));
+                            nearCount = vaddq_f32(nearCount, MaskNEON(neighbor, one));
+                        }
+                    }
+
+                    soa.sepX[i] = vaddvq_f32(sepX); soa.sepY[i] = vaddvq_f32(sepY); soa.sepCount[i] = vaddvq_f32(sepCount);
+                    soa.aliX[i] = vaddvq_f32(aliX); soa.aliY[i] = vaddvq_f32(aliY);
+                    soa.cohX[i] = vaddvq_f32(cohX); soa.cohY[i] = vaddvq_f32(cohY); soa.nearCount[i] = vaddvq_f32(nearCount);
+                }
+            }
+
+            inline void FinalizeNEON(BoidSoA& soa, BoidWeights weights, Vector2 mouse, float deltaTime, size_t begin, size_t end)
+            {
+                const float32x4_t zero = vdupq_n_f32(0.0f);
+                const float32x4_t one = vdupq_n_f32(1.0f);
+                const float32x4_t mouseX = vdupq_n_f32(mouse.x);
+                const float32x4_t mouseY = vdupq_n_f32(mouse.y);
+                const float32x4_t dt = vdupq_n_f32(deltaTime);
+
+                for (size_t i = begin; i < end; i += 4)
+                {
+                    const float32x4_t px = vld1q_f32(&soa.posX[i]), py = vld1q_f32(&soa.posY[i]);
+                    const float32x4_t vx = vld1q_f32(&soa.velX[i]), vy = vld1q_f32(&soa.velY[i]);
+                    const float32x4_t maxSpeed = vld1q_f32(&soa.maxSpeed[i]), maxForce = vld1q_f32(&soa.maxForce[i]);
+
+                    float32x4_t mx = vsubq_f32(mouseX, px);
+                    float32x4_t my = vsubq_f32(mouseY, py);
+                    float32x4_t distToMouse = vsqrtq_f32(vaddq_f32(vmulq_f32(mx, mx), vmulq_f32(my, my)));
+                    uint32x4_t followMouse = vcgtq_f32(distToMouse, one);
+                    SteerNEON(mx, my, distToMouse, vx, vy, maxSpeed, maxForce);
+                    mx = MaskNEON(followMouse, mx);
+                    my = MaskNEON(followMouse, my);
+
+                    float32x4_t sepX = vld1q_f32(&soa.sepX[i]), sepY = vld1q_f32(&soa.sepY[i]);
+                    float32x4_t aliX = vld1q_f32(&soa.aliX[i]), aliY = vld1q_f32(&soa.aliY[i]);
+                    float32x4_t cohX = vld1q_f32(&soa.cohX[i]), cohY = vld1q_f32(&soa.cohY[i]);
+                    float32x4_t sepCount = vld1q_f32(&soa.sepCount[i]), nearCount = vld1q_f32(&soa.nearCount[i]);
+
+                    uint32x4_t anySep = vcgtq_f32(sepCount, zero);
+                    sepX = vbslq_f32(anySep, vdivq_f32(sepX, sepCount), sepX);
+                    sepY = vbslq_f32(anySep, vdivq_f32(sepY, sepCount), sepY);
+
+                    uint32x4_t anyNear = vcgtq_f32(nearCount, zero);
+                    aliX = vbslq_f32(anyNear, vdivq_f32(aliX, nearCount), aliX);
+                    aliY = vbslq_f32(anyNear, vdivq_f32(aliY, nearCount), aliY);
+                    cohX = vbslq_f32(anyNear, vsubq_f32(vdivq_f32(cohX, nearCount), px), cohX);
+                    cohY = vbslq_f32(anyNear, vsubq_f32(vdivq_f32(cohY, nearCount), py), cohY);
+
+                    float32x4_t* forces[3][2] = { { &aliX, &aliY }, { &cohX, &cohY }, { &sepX, &sepY } };
+                    for (auto& force : forces)
+                    {
+                        float32x4_t x = *force[0], y = *force[1];
+                        float32x4_t length = vsqrtq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)));
+                        uint32x4_t steer = vcgtq_f32(length, zero);
+                        SteerNEON(x, y, length, vx, vy, maxSpeed, maxForce);
+                        *force[0] = vbslq_f32(steer, x, *force[0]);
+                        *force[1] = vbslq_f32(steer, y, *force[1]);
+                    }
+
+                    float32x4_t ax = vaddq_f32(zero, vmulq_n_f32(sepX, weights.separation));
+                    float32x4_t ay = vaddq_f32(zero, vmulq_n_f32(sepY, weights.separation));
+                    ax = vaddq_f32(ax, vmulq_n_f32(aliX, weights.alignment));
+                    ay = vaddq_f32(ay, vmulq_n_f32(aliY, weights.alignment));
+                    ax = vaddq_f32(ax, vmulq_n_f32(cohX, weights.cohesion));
+                    ay = vaddq_f32(ay, vmulq_n_f32(cohY, weights.cohesion));
+                    ax = vaddq_f32(ax, vmulq_n_f32(mx, weights.target));
+                    ay = vaddq_f32(ay, vmulq_n_f32(my, weights.target));
+
+                    // Clamp velocity
+                    float32x4_t nvx = vaddq_f32(vx, vmulq_f32(ax, dt));
+                    float32x4_t nvy = vaddq_f32(vy, vmulq_f32(ay, dt));
+                    float32x4_t velLength = vsqrtq_f32(vaddq_f32(vmulq_f32(nvx, nvx), vmulq_f32(nvy, nvy)));
+                    uint32x4_t clamp = vcgtq_f32(velLength, maxSpeed);
+                    nvx = vbslq_f32(clamp, vmulq_f32(vdivq_f32(nvx, velLength), maxSpeed), nvx);
+                    nvy = vbslq_f32(clamp, vmulq_f32(vdivq_f32(nvy, velLength), maxSpeed), nvy);
+
+                    vst1q_f32(&soa.accelX[i], ax); vst1q_f32(&soa.accelY[i], ay);
+                    vst1q_f32(&soa.newVelX[i], nvx); vst1q_f32(&soa.newVelY[i], nvy);
+                }
+            }
+#endif
+
+            /**
+             * @brief Runs the accumulate stage for boids [begin, end) with the given kernel
+             */
+            inline void Accumulate(SimdLevel level, const SpatialHashGrid& grid, BoidSoA& soa, size_t begin, size_t end)
+            {
+                switch (level)
+                {
+#if defined(SIMD_HAS_AVX2)
+                    case SimdLevel::AVX2: AccumulateAVX2(grid, soa, begin, end); return;
+#endif
+#if defined(SIMD_HAS_SSE)
+                    case SimdLevel::SSE: AccumulateSSE(grid, soa, begin, end); return;
+#endif
+#if defined(SIMD_HAS_NEON)
+                    case SimdLevel::NEON: AccumulateNEON(grid, soa, begin, end); return;
+#endif
+                    default: AccumulateScalar(grid, soa, begin, end); return;
+                }
+            }
+
+            /**
+             * @brief Runs the finalize stage for boids [begin, end) with the given kernel
+             *
+             * begin must be a multiple of KERNEL_WIDTH. SIMD kernels round end up to
+             * their width, which only ever spills into the padding of the arrays.
+             */
+            inline void Finalize(SimdLevel level, BoidSoA& soa, BoidWeights weights, Vector2 mouse, float deltaTime, size_t begin, size_t end)
+            {
+                switch (level)
+                {
+#if defined(SIMD_HAS_AVX2)
+                    case SimdLevel::AVX2: FinalizeAVX2(soa, weights, mouse, deltaTime, begin, end); return;
+#endif
+#if defined(SIMD_HAS_SSE)
+                    case SimdLevel::SSE: FinalizeSSE(soa, weights, mouse, deltaTime, begin, end); return;
+#endif
+#if defined(SIMD_HAS_NEON)
+                    case SimdLevel::NEON: FinalizeNEON(soa, weights, mouse, deltaTime, begin, end); return;
+#endif
+                    default: FinalizeScalar(soa, weights, mouse, deltaTime, begin, end); return;
+                }
+            }
+        }
+    }
+}
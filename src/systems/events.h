@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../utils/seecs.h"
+
+namespace seecs
+{
+    namespace events
+    {
+        enum class CollisionPhase
+        {
+            Begin, // First tick the pair overlaps
+            Stay,  // Still overlapping
+            End    // First tick the pair no longer overlaps, or one of them is gone
+        };
+
+        // Published by collision_system for every overlapping pair
+        struct CollisionEvent
+        {
+            seecs::EntityID first = seecs::NULL_ENTITY;  // Lower ID of the pair
+            seecs::EntityID second = seecs::NULL_ENTITY;
+            CollisionPhase phase = CollisionPhase::Begin;
+            bool isTrigger = false; // Either collider is a trigger
+        };
+
+        // Published by health_system once when an entity's health drops to zero
+        struct DeathEvent
+        {
+            seecs::EntityID id = seecs::NULL_ENTITY;
+        };
+    }
+}
@@ -0,0 +1,397 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "components.h"
+#include "boid_kernels.h"
+#include "../utils/seecs.h"
+#include "../utils/spatial_grid.h"
+
+/*
+* Batched drawing for the render system, split in a CPU and a GPU half:
+*  - Build: writes flat draw lists for what is inside the view, one vertex
+*    array for every boid triangle and one quad list for sprites sorted by
+*    texture. It doesn't touch the GPU, so headless runs can time it.
+*  - Submit: uploads the boid vertices into a single dynamic vertex buffer drawn
+*    with two draw calls (fill, then outline), and draws sprites with one rlgl
+*    batch per texture instead of a state change per sprite.
+*/
+namespace seecs
+{
+    using namespace components;
+
+    namespace systems
+    {
+        namespace render_system
+        {
+            constexpr float BOID_SIZE = 10.0f;
+            constexpr Color BOID_FILL = BLACK;
+            constexpr Color BOID_OUTLINE = RED;
+            constexpr float BOID_EXTENT = BOID_SIZE*1.12f; // Farthest triangle corner from the position, sqrt(1 + 0.5^2)
+
+            // Corners in DrawTexturePro order: top-left, bottom-left, bottom-right, top-right
+            struct SpriteQuad
+            {
+                unsigned int textureId = 0;
+                Vector2 corners[4] = {};
+                Vector2 texcoords[4] = {};
+                Color tint = WHITE;
+            };
+
+            // Entities the last Build() kept or dropped for being outside the view
+            struct CullStats
+            {
+                size_t boidsDrawn = 0;
+                size_t boidsCulled = 0;
+                size_t spritesDrawn = 0;
+                size_t spritesCulled = 0;
+            };
+
+            // Draw lists for one frame, kept between frames so building doesn't allocate
+            struct Batch
+            {
+                std::vector<Vector2> boidVertices; // Three per boid, counter-clockwise on screen
+                std::vector<SpriteQuad> sprites;   // Sorted by texture
+                size_t textureRuns = 0;            // Consecutive sprites sharing a texture, one rlgl draw each
+                CullStats stats;
+            };
+
+            /**
+             * @brief World space area seen through camera on a screenWidth x screenHeight target
+             *
+             * Bounding box of the four screen corners, so a rotated camera gets a
+             * slightly larger area than it shows.
+             */
+            inline Rectangle GetViewBounds(const Camera2D& camera, float screenWidth, float screenHeight)
+            {
+                const Vector2 corners[4] = {
+                    GetScreenToWorld2D({ 0.0f, 0.0f }, camera),
+                    GetScreenToWorld2D({ screenWidth, 0.0f }, camera),
+                    GetScreenToWorld2D({ 0.0f, screenHeight }, camera),
+                    GetScreenToWorld2D({ screenWidth, screenHeight }, camera)
+                };
+
+                Vector2 min = corners[0];
+                Vector2 max = corners[0];
+                for (const Vector2& corner : corners)
+                {
+                    min = { std::min(min.x, corner.x), std::min(min.y, corner.y) };
+                    max = { std::max(max.x, corner.x), std::max(max.y, corner.y) };
+                }
+                return { min.x, min.y, max.x - min.x, max.y - min.y };
+            }
+
+            inline Rectangle ExpandRect(Rectangle rect, float margin)
+            {
+                return { rect.x - margin, rect.y - margin, rect.width + 2.0f*margin, rect.height + 2.0f*margin };
+            }
+
+            inline bool ContainsPoint(const Rectangle& rect, float x, float y)
+            {
+                return (x >= rect.x) && (x <= rect.x + rect.width) && (y >= rect.y) && (y <= rect.y + rect.height);
+            }
+
+            // Appends the triangle of a boid pointing along its velocity
+            inline void EmitBoid(std::vector<Vector2>& vertices, float x, float y, float velocityX, float velocityY)
+            {
+                float dirX = velocityX;
+                float dirY = velocityY;
+                float length = sqrtf(dirX*dirX + dirY*dirY);
+
+                if (length < 0.1f)
+                {
+                    dirX = 0.0f; // Default upward if not moving
+                    dirY = -1.0f;
+                }
+                else
+                {
+                    dirX /= length;
+                    dirY /= length;
+                }
+
+                const float backX = x - dirX*BOID_SIZE;
+                const float backY = y - dirY*BOID_SIZE;
+                const float sideX = dirY*BOID_SIZE*0.5f;
+                const float sideY = dirX*BOID_SIZE*0.5f;
+
+                // Tip, then the back corner left of the heading, then the right one.
+                // Counter-clockwise on screen, rlgl culls clockwise triangles.
+                vertices.push_back({ x, y });
+                vertices.push_back({ backX + sideX, backY - sideY });
+                vertices.push_back({ backX - sideX, backY + sideY });
+            }
+
+            /*
+            * Boids whose position is within BOID_EXTENT of the view. The boid view is
+            * an owning group, so this walks three packed arrays in order.
+            */
+            inline void BuildBoids(seecs::ECS& ecs, Batch& batch, const Rectangle& view)
+            {
+                auto boids = ecs.View<Transform, Motion, Boid>();
+                batch.boidVertices.clear();
+                batch.boidVertices.reserve(3*boids.SizeHint());
+
+                const Rectangle bounds = ExpandRect(view, BOID_EXTENT);
+                size_t total = 0;
+                boids.Each([&](Transform& transform, Motion& motion, Boid&)
+                {
+                    total++;
+                    if (!ContainsPoint(bounds, transform.position.x, transform.position.y)) return;
+                    EmitBoid(batch.boidVertices, transform.position.x, transform.position.y, motion.velocity.x, motion.velocity.y);
+                });
+
+                batch.stats.boidsDrawn = batch.boidVertices.size()/3;
+                batch.stats.boidsCulled = total - batch.stats.boidsDrawn;
+            }
+
+            /*
+            * Same as above, but only visits the boids in the grid cells overlapping
+            * the view. grid and soa are boid_system's from its last tick: positions
+            * and velocities come from the gathered columns, which hold the values
+            * written back to the ECS that tick.
+            */
+            inline void BuildBoids(SpatialHashGrid& grid, const boid_system::BoidSoA& soa, Batch& batch, const Rectangle& view)
+            {
+                const size_t total = grid.GetPointCount();
+                batch.boidVertices.clear();
+                batch.boidVertices.reserve(3*total);
+
+                const Rectangle bounds = ExpandRect(view, BOID_EXTENT);
+                grid.ForEachInRect(bounds, [&](uint32_t i)
+                {
+                    if (!ContainsPoint(bounds, soa.posX[i], soa.posY[i])) return;
+                    EmitBoid(batch.boidVertices, soa.posX[i], soa.posY[i], soa.newVelX[i], soa.newVelY[i]);
+                });
+
+                batch.stats.boidsDrawn = batch.boidVertices.size()/3;
+                batch.stats.boidsCulled = total - batch.stats.boidsDrawn;
+            }
+
+            // Same corner and texture coordinate math as DrawTexturePro, origin at the sprite center
+            inline SpriteQuad MakeSpriteQuad(const Transform& transform, const Sprite& sprite)
+            {
+                SpriteQuad quad;
+                quad.textureId = sprite.texture.id;
+                quad.tint = sprite.tint;
+
+                const Rectangle source = sprite.sourceRect;
+                const float width = fabsf(source.width)*transform.scale.x;
+                const float height = fabsf(source.height)*transform.scale.y;
+                const float dx = -width/2.0f;
+                const float dy = -height/2.0f;
+                const float x = transform.position.x;
+                const float y = transform.position.y;
+
+                const float sinRotation = sinf(transform.rotation*DEG2RAD);
+                const float cosRotation = cosf(transform.rotation*DEG2RAD);
+
+                quad.corners[0] = { x + dx*cosRotation - dy*sinRotation, y + dx*sinRotation + dy*cosRotation };
+                quad.corners[1] = { x + dx*cosRotation - (dy + height)*sinRotation, y + dx*sinRotation + (dy + height)*cosRotation };
+                quad.corners[2] = { x + (dx + width)*cosRotation - (dy + height)*sinRotation, y + (dx + width)*sinRotation + (dy + height)*cosRotation };
+                quad.corners[3] = { x + (dx + width)*cosRotation - dy*sinRotation, y + (dx + width)*sinRotation + dy*cosRotation };
+
+                // A negative source size flips like in DrawTexturePro, the flip flags flip again
+                const bool flipX = (source.width < 0.0f) != sprite.flipX;
+                const bool flipY = (source.height < 0.0f) != sprite.flipY;
+                const float textureWidth = (float)sprite.texture.width;
+                const float textureHeight = (float)sprite.texture.height;
+
+                float left = source.x/textureWidth;
+                float right = (source.x + fabsf(source.width))/textureWidth;
+                float top = source.y/textureHeight;
+                float bottom = (source.y + fabsf(source.height))/textureHeight;
+                if (flipX) std::swap(left, right);
+                if (flipY) std::swap(top, bottom);
+
+                quad.texcoords[0] = { left, top };
+                quad.texcoords[1] = { left, bottom };
+                quad.texcoords[2] = { right, bottom };
+                quad.texcoords[3] = { right, top };
+                return quad;
+            }
+
+            /*
+            * Sprites are sorted by texture so each texture is bound once. The sort
+            * is stable, sprites sharing a texture keep their relative draw order.
+            * A sprite is culled when the circle around its rotated quad misses the view.
+            */
+            inline void BuildSprites(seecs::ECS& ecs, Batch& batch, const Rectangle& view)
+            {
+                batch.sprites.clear();
+                batch.stats.spritesCulled = 0;
+                ecs.View<Transform, Sprite>().Each([&](Transform& transform, Sprite& sprite)
+                {
+                    if (sprite.texture.id == 0) return; // Skip if no texture
+
+                    const float halfWidth = fabsf(sprite.sourceRect.width*transform.scale.x)*0.5f;
+                    const float halfHeight = fabsf(sprite.sourceRect.height*transform.scale.y)*0.5f;
+                    const float radius = sqrtf(halfWidth*halfWidth + halfHeight*halfHeight);
+                    if (!ContainsPoint(ExpandRect(view, radius), transform.position.x, transform.position.y))
+                    {
+                        batch.stats.spritesCulled++;
+                        return;
+                    }
+
+                    batch.sprites.push_back(MakeSpriteQuad(transform, sprite));
+                });
+                batch.stats.spritesDrawn = batch.sprites.size();
+
+                std::stable_sort(batch.sprites.begin(), batch.sprites.end(),
+                    [](const SpriteQuad& a, const SpriteQuad& b) { return a.textureId < b.textureId; });
+
+                batch.textureRuns = 0;
+                for (size_t i = 0; i < batch.sprites.size(); i++)
+                {
+                    if ((i == 0) || (batch.sprites[i].textureId != batch.sprites[i - 1].textureId)) batch.textureRuns++;
+                }
+            }
+
+            inline void Build(seecs::ECS& ecs, Batch& batch, const Rectangle& view)
+            {
+                BuildSprites(ecs, batch, view);
+                BuildBoids(ecs, batch, view);
+            }
+
+            /**
+             * @brief GPU vertex buffer the boid triangles are streamed into every frame
+             *
+             * Drawn with raylib's default shader, positions only, the color comes
+             * from the shader's diffuse color. Needs a GL context: create and
+             * destroy it while the window is open.
+             */
+            class BoidMesh
+            {
+            public:
+                BoidMesh() = default;
+                BoidMesh(const BoidMesh&) = delete;
+                BoidMesh& operator=(const BoidMesh&) = delete;
+
+                ~BoidMesh()
+                {
+                    Unload();
+                }
+
+                void Draw(const std::vector<Vector2>& vertices)
+                {
+                    if (vertices.empty()) return;
+
+                    // Everything queued through rlgl so far must land below the boids
+                    rlDrawRenderBatchActive();
+
+                    const int bytes = (int)(vertices.size()*sizeof(Vector2));
+                    if (bytes > m_capacityBytes)
+                    {
+                        // Grow with headroom so a slowly growing flock doesn't reallocate every frame
+                        Unload();
+                        m_capacityBytes = bytes + bytes/2;
+                        m_vao = rlLoadVertexArray();
+                        rlEnableVertexArray(m_vao);
+                        m_vbo = rlLoadVertexBuffer(nullptr, m_capacityBytes, true);
+                    }
+
+                    // Without VAO support (GLES2) the attribute has to be set up on every draw
+                    rlEnableVertexArray(m_vao);
+                    rlEnableVertexBuffer(m_vbo);
+                    rlUpdateVertexBuffer(m_vbo, vertices.data(), bytes, 0);
+                    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 2, RL_FLOAT, false, 0, 0);
+                    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+
+                    // Texcoords default to (0, 0) and sample the white default texture,
+                    // vertex colors default to white, so the diffuse color is the final color
+                    const float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+                    rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, white, RL_SHADER_ATTRIB_VEC4, 1);
+
+                    int* locs = rlGetShaderLocsDefault();
+                    rlEnableShader(rlGetShaderIdDefault());
+                    rlSetUniformMatrix(locs[RL_SHADER_LOC_MATRIX_MVP], MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+                    rlActiveTextureSlot(0);
+                    rlEnableTexture(rlGetTextureIdDefault());
+
+                    SetColor(locs, BOID_FILL);
+                    rlDrawVertexArray(0, (int)vertices.size());
+
+#if !defined(PLATFORM_WEB)
+                    // Wire mode turns the same triangles into outlines
+                    SetColor(locs, BOID_OUTLINE);
+                    rlEnableWireMode();
+                    rlDrawVertexArray(0, (int)vertices.size());
+                    rlDisableWireMode();
+#endif
+
+                    rlDisableTexture();
+                    rlDisableShader();
+                    rlDisableVertexArray();
+                    rlDisableVertexBuffer();
+
+#if defined(PLATFORM_WEB)
+                    // GLES2 has no wire mode, queue the outlines as rlgl lines instead
+                    rlBegin(RL_LINES);
+                    rlColor4ub(BOID_OUTLINE.r, BOID_OUTLINE.g, BOID_OUTLINE.b, BOID_OUTLINE.a);
+                    for (size_t i = 0; i < vertices.size(); i += 3)
+                    {
+                        for (int edge = 0; edge < 3; edge++)
+                        {
+                            const Vector2 from = vertices[i + edge];
+                            const Vector2 to = vertices[i + (edge + 1)%3];
+                            rlVertex2f(from.x, from.y);
+                            rlVertex2f(to.x, to.y);
+                        }
+                    }
+                    rlEnd();
+#endif
+                }
+
+            private:
+                unsigned int m_vao = 0;
+                unsigned int m_vbo = 0;
+                int m_capacityBytes = 0;
+
+                static void SetColor(int* locs, Color color)
+                {
+                    const float diffuse[4] = { color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f };
+                    rlSetUniform(locs[RL_SHADER_LOC_COLOR_DIFFUSE], diffuse, RL_SHADER_UNIFORM_VEC4, 1);
+                }
+
+                void Unload()
+                {
+                    if (m_vbo != 0) rlUnloadVertexBuffer(m_vbo);
+                    if (m_vao != 0) rlUnloadVertexArray(m_vao);
+                    m_vbo = 0;
+                    m_vao = 0;
+                    m_capacityBytes = 0;
+                }
+            };
+
+            // One rlgl quad batch per texture run, rlgl merges quads sharing a texture into one draw
+            inline void SubmitSprites(const Batch& batch)
+            {
+                size_t i = 0;
+                while (i < batch.sprites.size())
+                {
+                    const unsigned int textureId = batch.sprites[i].textureId;
+                    rlSetTexture(textureId);
+                    rlBegin(RL_QUADS);
+                    rlNormal3f(0.0f, 0.0f, 1.0f);
+
+                    for (; (i < batch.sprites.size()) && (batch.sprites[i].textureId == textureId); i++)
+                    {
+                        const SpriteQuad& quad = batch.sprites[i];
+                        rlColor4ub(quad.tint.r, quad.tint.g, quad.tint.b, quad.tint.a);
+                        for (int corner = 0; corner < 4; corner++)
+                        {
+                            rlTexCoord2f(quad.texcoords[corner].x, quad.texcoords[corner].y);
+                            rlVertex2f(quad.corners[corner].x, quad.corners[corner].y);
+                        }
+                    }
+
+                    rlEnd();
+                }
+                rlSetTexture(0);
+            }
+        }
+    }
+}
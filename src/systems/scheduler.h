@@ -0,0 +1,227 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../utils/seecs.h"
+#include "../utils/job_system.h"
+#include "../utils/command_buffer.h"
+#include "../utils/profiler.h"
+
+namespace seecs
+{
+    namespace systems
+    {
+        /**
+         * @brief Components a system reads and writes, used to order systems
+         *
+         * Two systems conflict when one writes a component the other reads or
+         * writes. Exclusive systems (structural changes, global state) conflict
+         * with everything.
+         */
+        class SystemAccess
+        {
+        public:
+            explicit SystemAccess(seecs::ECS& ecs) : m_ecs(&ecs) {}
+
+            template <typename... Ts>
+            SystemAccess& Read()
+            {
+                m_reads |= m_ecs->MaskOf<Ts...>();
+                m_ecs->RegisterPools<Ts...>();
+                return *this;
+            }
+
+            template <typename... Ts>
+            SystemAccess& Write()
+            {
+                m_writes |= m_ecs->MaskOf<Ts...>();
+                m_ecs->RegisterPools<Ts...>();
+                return *this;
+            }
+
+            SystemAccess& Exclusive()
+            {
+                m_exclusive = true;
+                return *this;
+            }
+
+            bool ConflictsWith(const SystemAccess& other) const
+            {
+                if (m_exclusive || other.m_exclusive) return true;
+                return (m_writes & (other.m_reads | other.m_writes)).any() || (other.m_writes & m_reads).any();
+            }
+
+        private:
+            seecs::ECS* m_ecs;
+            seecs::ComponentMask m_reads;
+            seecs::ComponentMask m_writes;
+            bool m_exclusive = false;
+        };
+
+        /**
+         * @brief Runs systems as a dependency graph built from their declared access
+         *
+         * A system depends on every system registered before it that it conflicts
+         * with, so registration order is kept wherever it matters. Systems are
+         * grouped into levels (longest dependency chain leading to them) and the
+         * systems of a level run in parallel on the job system.
+         *
+         * Systems must only touch the components they declare, and must not make
+         * structural changes unless they're declared Exclusive(). Others record
+         * them into a CommandQueue, which Run() plays back after every level.
+         */
+        class SystemScheduler
+        {
+        public:
+            using SystemFunc = std::function<void(float)>;
+
+            struct SystemInfo
+            {
+                std::string name;
+                SystemAccess access;
+                SystemFunc func;
+                std::vector<size_t> dependencies;
+                size_t level = 0;
+                double lastMs = 0.0;    // Duration of the last run
+                double averageMs = 0.0; // Exponential moving average
+            };
+
+            void Add(const std::string& name, const SystemAccess& access, SystemFunc func)
+            {
+                SystemInfo info = { .name = name, .access = access, .func = std::move(func), .dependencies = {}, .level = 0, .lastMs = 0.0, .averageMs = 0.0 };
+
+                for (size_t i = 0; i < m_systems.size(); i++)
+                {
+                    if (!access.ConflictsWith(m_systems[i].access)) continue;
+
+                    info.dependencies.push_back(i);
+                    info.level = std::max(info.level, m_systems[i].level + 1);
+                }
+
+                if (info.level >= m_levels.size()) m_levels.resize(info.level + 1);
+                m_levels[info.level].push_back(m_systems.size());
+                m_systems.push_back(std::move(info));
+            }
+
+            void Run(JobSystem& jobs, float deltaTime)
+            {
+                RunLevels(jobs, deltaTime, [] {});
+            }
+
+            /**
+             * @brief Run every level, applying the commands it recorded before the next one starts
+             */
+            void Run(JobSystem& jobs, float deltaTime, seecs::ECS& ecs, CommandQueue& commands)
+            {
+                RunLevels(jobs, deltaTime, [&]
+                {
+                    if (commands.Empty()) return;
+                    PROFILE_ZONE("playback");
+                    commands.Playback(ecs);
+                });
+            }
+
+            const std::vector<SystemInfo>& GetSystems() const { return m_systems; }
+            const std::vector<std::vector<size_t>>& GetLevels() const { return m_levels; }
+
+            /**
+             * @brief Longest chain of dependent systems by their last run time
+             * @param path Receives the systems on the chain, first to last
+             * @return Total duration of the chain in milliseconds
+             */
+            double GetCriticalPath(std::vector<size_t>* path = nullptr) const
+            {
+                // Systems are in topological order already, dependencies come first
+                std::vector<double> finish(m_systems.size(), 0.0);
+                std::vector<size_t> previous(m_systems.size(), m_systems.size());
+                size_t last = 0;
+
+                for (size_t i = 0; i < m_systems.size(); i++)
+                {
+                    double start = 0.0;
+                    for (size_t dep : m_systems[i].dependencies)
+                    {
+                        if (finish[dep] > start) { start = finish[dep]; previous[i] = dep; }
+                    }
+
+                    finish[i] = start + m_systems[i].lastMs;
+                    if (finish[i] > finish[last]) last = i;
+                }
+
+                if (m_systems.empty()) return 0.0;
+
+                if (path)
+                {
+                    path->clear();
+                    for (size_t i = last; i < m_systems.size(); i = previous[i]) path->insert(path->begin(), i);
+                }
+
+                return finish[last];
+            }
+
+            /**
+             * @brief Human readable schedule with per-system timings
+             */
+            std::string DescribeSchedule() const
+            {
+                std::stringstream ss;
+                for (size_t l = 0; l < m_levels.size(); l++)
+                {
+                    ss << "level " << l << ":";
+                    for (size_t i : m_levels[l])
+                    {
+                        ss << " " << m_systems[i].name << " (" << m_systems[i].averageMs << " ms)";
+                    }
+                    ss << "\n";
+                }
+
+                std::vector<size_t> path;
+                double total = GetCriticalPath(&path);
+                ss << "critical path:";
+                for (size_t i : path) ss << " " << m_systems[i].name;
+                ss << " = " << total << " ms\n";
+
+                return ss.str();
+            }
+
+        private:
+            std::vector<SystemInfo> m_systems;
+            std::vector<std::vector<size_t>> m_levels;
+
+            template <typename AfterLevel>
+            void RunLevels(JobSystem& jobs, float deltaTime, AfterLevel&& afterLevel)
+            {
+                for (const std::vector<size_t>& level : m_levels)
+                {
+                    if (level.size() == 1)
+                    {
+                        RunSystem(m_systems[level[0]], deltaTime);
+                    }
+                    else
+                    {
+                        jobs.ParallelFor(level.size(), 1, [&](size_t begin, size_t end)
+                        {
+                            for (size_t i = begin; i < end; i++) RunSystem(m_systems[level[i]], deltaTime);
+                        });
+                    }
+
+                    afterLevel();
+                }
+            }
+
+            static void RunSystem(SystemInfo& system, float deltaTime)
+            {
+                PROFILE_ZONE(system.name.c_str());
+                auto start = std::chrono::steady_clock::now();
+                system.func(deltaTime);
+                auto end = std::chrono::steady_clock::now();
+
+                system.lastMs = std::chrono::duration<double, std::milli>(end - start).count();
+                system.averageMs = (system.averageMs == 0.0)? system.lastMs : system.averageMs*0.95 + system.lastMs*0.05;
+            }
+        };
+    }
+}
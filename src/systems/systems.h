@@ -4,210 +4,131 @@
 #include <string>
 #include <vector>
 #include <cmath>
+#include <memory>
+#include <span>
 #include "components.h"
+#include "events.h"
 #include "../utils/seecs.h"
+#include "../utils/spatial_grid.h"
+#include "../utils/frame_arena.h"
+#include "../utils/broad_phase.h"
+#include "../utils/event_bus.h"
+#include "../utils/log_sink.h"
+#include "../utils/profiler.h"
+#include "../utils/job_system.h"
+#include "../utils/command_buffer.h"
+#include "boid_kernels.h"
+#include "render_batch.h"
+#include "scheduler.h"
 
 // ECS Systems namespace
 namespace seecs
 {
     using namespace components;
+    using namespace events;
 
     namespace systems
     {
         // Boid System - Updates boid movement and makes them follow the mouse
         namespace boid_system
         {
-            inline void Update(seecs::ECS& ecs, float deltaTime)
+            // Persistent state kept between ticks so buffers are reused.
+            // Per-boid arrays are indexed by gather order, which is the dense
+            // order of the view for this tick. They live in the scratch arena,
+            // which is reset at the start of every tick.
+            struct State
+            {
+                SpatialHashGrid grid;
+                FrameArena scratch;
+                BoidSoA soa;
+                std::span<Motion*> motions;
+
+                BoidWeights weights;
+
+                // Kernel set used for steering, override to compare against Scalar
+                SimdLevel simdLevel = DetectSimdLevel();
+
+                // Scan every boid for neighbors instead of the grid, only to benchmark the grid
+                bool bruteForceNeighbors = false;
+            };
+
+            /*
+            * Runs in three passes so the view is only walked once per tick:
+            *  - gather: copy positions, velocities and parameters to SoA arrays, keep a Motion* per boid
+            *  - compute: neighbor sums then steering for every boid in parallel, reading gathered data only
+            *  - scatter: write accelerations and velocities back in one linear pass
+            * Boids steer towards target, the mouse position when running with a window.
+            */
+            inline void Update(seecs::ECS& ecs, JobSystem& jobs, State& state, Vector2 target, float deltaTime)
             {
                 auto view = ecs.View<Transform, Motion, Boid>();
-                std::vector<Vector2> positions;
-                std::vector<Vector2> velocities;
-                std::vector<seecs::EntityID> ids;
 
-                // Gather all boid positions and velocities
-                view.ForEach([&](seecs::EntityID id, Transform& t, Motion& m, Boid&)
+                // Size the scratch once for the whole tick, so a spawn wave
+                // doesn't regrow every column during the gather
+                BoidSoA& soa = state.soa;
+                state.scratch.Reset();
+                const size_t capacity = view.SizeHint();
+                soa.Allocate(state.scratch, capacity);
+                state.motions = state.scratch.AllocateArray<Motion*>(capacity);
+
+                // Gather
+                size_t count = 0;
+                float maxRadius = 0.0f;
                 {
-                    positions.push_back(t.position);
-                    velocities.push_back(m.velocity);
-                    ids.push_back(id);
-                });
-
-                // For each boid, calculate steering forces
-                for (size_t i = 0; i < ids.size(); ++i)
-                {
-                    Vector2 pos = positions[i];
-                    Vector2 vel = velocities[i];
-                    Boid* boid = nullptr;
-                    Transform* t = nullptr;
-                    Motion* m = nullptr;
-
-                    view.ForEach([&](seecs::EntityID id, Transform& t_, Motion& m_, Boid& b_)
+                    PROFILE_ZONE("boid_gather");
+                    view.Each([&](Transform& t, Motion& m, Boid& b)
                     {
-                        if (id == ids[i]) { t = &t_; m = &m_; boid = &b_; }
+                        soa.posX[count] = t.position.x;
+                        soa.posY[count] = t.position.y;
+                        soa.velX[count] = m.velocity.x;
+                        soa.velY[count] = m.velocity.y;
+                        soa.maxSpeed[count] = b.maxSpeed;
+                        soa.maxForce[count] = b.maxForce;
+                        soa.separationRadius[count] = b.separationRadius;
+                        soa.neighborRadius[count] = b.neighborRadius;
+                        state.motions[count] = &m;
+                        count++;
+                        maxRadius = std::max(maxRadius, std::max(b.neighborRadius, b.separationRadius));
                     });
 
-                    if (!boid || !t || !m) continue;
-
-                    Vector2 mouse = {(float)GetMouseX(), (float)GetMouseY()};
-                    Vector2 steerToMouse = {mouse.x - pos.x, mouse.y - pos.y}; // Manual Vector2Subtract
-                    float distToMouse = sqrtf(steerToMouse.x * steerToMouse.x + steerToMouse.y * steerToMouse.y); // Manual Vector2Length
-
-                    if (distToMouse > 1.0f)
-                    {
-                        // Manual Vector2Normalize and Vector2Scale
-                        float length = distToMouse;
-                        steerToMouse.x = (steerToMouse.x / length) * boid->maxSpeed;
-                        steerToMouse.y = (steerToMouse.y / length) * boid->maxSpeed;
-                        steerToMouse.x -= vel.x;
-                        steerToMouse.y -= vel.y; // Manual Vector2Subtract
-
-                        float steerLength = sqrtf(steerToMouse.x * steerToMouse.x + steerToMouse.y * steerToMouse.y);
-                        if (steerLength > boid->maxForce)
-                        {
-                            steerToMouse.x = (steerToMouse.x / steerLength) * boid->maxForce;
-                            steerToMouse.y = (steerToMouse.y / steerLength) * boid->maxForce;
-                        }
-                    }
-                    else
-                    {
-                        steerToMouse = {0, 0};
-                    }
-
-                    // Separation, Alignment, Cohesion
-                    Vector2 sep = {0, 0};
-                    Vector2 ali = {0, 0};
-                    Vector2 coh = {0, 0};
-                    int sepCount = 0, aliCount = 0, cohCount = 0;
-
-                    for (size_t j = 0; j < ids.size(); ++j)
-                    {
-                        if (i == j) continue;
-
-                        Vector2 diff = {pos.x - positions[j].x, pos.y - positions[j].y};
-                        float d = sqrtf(diff.x * diff.x + diff.y * diff.y); // Manual Vector2Distance
-
-                        if (d < boid->separationRadius && d > 0)
-                        {
-                            diff.x = (diff.x / d) * (1.0f / d); // Manual Vector2Normalize and Vector2Scale
-                            diff.y = (diff.y / d) * (1.0f / d);
-                            sep.x += diff.x; // Manual Vector2Add
-                            sep.y += diff.y;
-                            sepCount++;
-                        }
-
-                        if (d < boid->neighborRadius)
-                        {
-                            ali.x += velocities[j].x; // Manual Vector2Add
-                            ali.y += velocities[j].y;
-                            coh.x += positions[j].x; // Manual Vector2Add
-                            coh.y += positions[j].y;
-                            aliCount++;
-                            cohCount++;
-                        }
-                    }
-
-                    if (sepCount > 0)
-                    {
-                        sep.x /= sepCount; // Manual Vector2Scale
-                        sep.y /= sepCount;
-                    }
-
-                    if (aliCount > 0)
-                    {
-                        ali.x /= aliCount; // Manual Vector2Scale
-                        ali.y /= aliCount;
-                    }
-
-                    if (cohCount > 0)
-                    {
-                        coh.x /= cohCount; // Manual Vector2Scale
-                        coh.y /= cohCount;
-                        coh.x -= pos.x; // Manual Vector2Subtract
-                        coh.y -= pos.y;
-                    }
-
-                    // Steering for alignment and cohesion
-                    float aliLength = sqrtf(ali.x * ali.x + ali.y * ali.y);
-                    if (aliLength > 0)
-                    {
-                        ali.x = (ali.x / aliLength) * boid->maxSpeed; // Manual Vector2Normalize and Vector2Scale
-                        ali.y = (ali.y / aliLength) * boid->maxSpeed;
-                        ali.x -= vel.x; // Manual Vector2Subtract
-                        ali.y -= vel.y;
-
-                        float aliSteerLength = sqrtf(ali.x * ali.x + ali.y * ali.y);
-                        if (aliSteerLength > boid->maxForce)
-                        {
-                            ali.x = (ali.x / aliSteerLength) * boid->maxForce;
-                            ali.y = (ali.y / aliSteerLength) * boid->maxForce;
-                        }
-                    }
+                    soa.Pad(count);
+                }
 
-                    float cohLength = sqrtf(coh.x * coh.x + coh.y * coh.y);
-                    if (cohLength > 0)
-                    {
-                        coh.x = (coh.x / cohLength) * boid->maxSpeed; // Manual Vector2Normalize and Vector2Scale
-                        coh.y = (coh.y / cohLength) * boid->maxSpeed;
-                        coh.x -= vel.x; // Manual Vector2Subtract
-                        coh.y -= vel.y;
-
-                        float cohSteerLength = sqrtf(coh.x * coh.x + coh.y * coh.y);
-                        if (cohSteerLength > boid->maxForce)
-                        {
-                            coh.x = (coh.x / cohSteerLength) * boid->maxForce;
-                            coh.y = (coh.y / cohSteerLength) * boid->maxForce;
-                        }
-                    }
+                // Bucket boids so neighbor search only visits the 3x3 cells around
+                // each boid, then lay the neighbor data out in bucket order
+                {
+                    PROFILE_ZONE("boid_grid");
+                    state.grid.Build(count, [&](size_t i) { return Vector2{soa.posX[i], soa.posY[i]}; }, maxRadius);
+                    soa.SortByGrid(state.grid);
+                }
 
-                    float sepLength = sqrtf(sep.x * sep.x + sep.y * sep.y);
-                    if (sepLength > 0)
-                    {
-                        sep.x = (sep.x / sepLength) * boid->maxSpeed; // Manual Vector2Normalize and Vector2Scale
-                        sep.y = (sep.y / sepLength) * boid->maxSpeed;
-                        sep.x -= vel.x; // Manual Vector2Subtract
-                        sep.y -= vel.y;
-
-                        float sepSteerLength = sqrtf(sep.x * sep.x + sep.y * sep.y);
-                        if (sepSteerLength > boid->maxForce)
-                        {
-                            sep.x = (sep.x / sepSteerLength) * boid->maxForce;
-                            sep.y = (sep.y / sepSteerLength) * boid->maxForce;
-                        }
-                    }
+                // Compute, each boid only writes its own output slots. The grain is a
+                // multiple of KERNEL_WIDTH so finalize ranges start on a full vector.
+                const SimdLevel level = state.simdLevel;
+                const BoidWeights weights = state.weights;
+                jobs.ParallelFor(count, 256, [&](size_t begin, size_t end)
+                {
+                    PROFILE_ZONE("boid_steer");
+                    if (state.bruteForceNeighbors) AccumulateBruteForce(soa, count, begin, end);
+                    else Accumulate(level, state.grid, soa, begin, end);
+                    Finalize(level, soa, weights, target, deltaTime, begin, end);
+                });
 
-                    // Weights for each behavior
-                    float sepWeight = 1.5f, aliWeight = 1.0f, cohWeight = 1.0f, mouseWeight = 1.2f;
-                    Vector2 accel = {0, 0};
-                    accel.x += sep.x * sepWeight; // Manual Vector2Add and Vector2Scale
-                    accel.y += sep.y * sepWeight;
-                    accel.x += ali.x * aliWeight;
-                    accel.y += ali.y * aliWeight;
-                    accel.x += coh.x * cohWeight;
-                    accel.y += coh.y * cohWeight;
-                    accel.x += steerToMouse.x * mouseWeight;
-                    accel.y += steerToMouse.y * mouseWeight;
-
-                    m->acceleration = accel;
-
-                    // Clamp velocity
-                    m->velocity.x += m->acceleration.x * deltaTime; // Manual Vector2Add and Vector2Scale
-                    m->velocity.y += m->acceleration.y * deltaTime;
-
-                    float velLength = sqrtf(m->velocity.x * m->velocity.x + m->velocity.y * m->velocity.y);
-                    if (velLength > boid->maxSpeed)
-                    {
-                        m->velocity.x = (m->velocity.x / velLength) * boid->maxSpeed; // Manual Vector2Normalize and Vector2Scale
-                        m->velocity.y = (m->velocity.y / velLength) * boid->maxSpeed;
-                    }
+                // Scatter
+                PROFILE_ZONE("boid_scatter");
+                for (size_t i = 0; i < count; ++i)
+                {
+                    state.motions[i]->acceleration = {soa.accelX[i], soa.accelY[i]};
+                    state.motions[i]->velocity = {soa.newVelX[i], soa.newVelY[i]};
                 }
             }
         }
 
         // Movement System - Updates position based on velocity and acceleration
         namespace movement_system {
-            inline void Update(seecs::ECS& ecs, float deltaTime) {
+            inline void Update(seecs::ECS& ecs, JobSystem& jobs, float deltaTime) {
                 auto view = ecs.View<Transform, Motion>();
-                view.ForEach([&](seecs::EntityID id, Transform& transform, Motion& motion) {
+                view.ParallelEach(jobs, [&](Transform& transform, Motion& motion) {
                     // Update velocity based on acceleration
                     motion.velocity.x += motion.acceleration.x * deltaTime;
                     motion.velocity.y += motion.acceleration.y * deltaTime;
@@ -219,118 +140,137 @@ namespace seecs
             }
         }
 
-        // Render System - Draws sprites and boids
+        // Render System - Draws sprites and boids inside the camera view, see render_batch.h
         namespace render_system {
-            inline void Update(seecs::ECS& ecs) {
-                // Render sprites (for any remaining sprite entities)
-                auto spriteView = ecs.View<Transform, Sprite>();
-                spriteView.ForEach([&](seecs::EntityID id, Transform& transform, Sprite& sprite) {
-                    if (sprite.texture.id == 0) return; // Skip if no texture
-
-                    Rectangle destRect = {
-                        transform.position.x,
-                        transform.position.y,
-                        sprite.sourceRect.width * transform.scale.x,
-                        sprite.sourceRect.height * transform.scale.y
-                    };
-
-                    // Apply flipping
-                    int flipX = sprite.flipX ? -1 : 1;
-                    int flipY = sprite.flipY ? -1 : 1;
-
-                    DrawTexturePro(
-                        sprite.texture,
-                        sprite.sourceRect,
-                        destRect,
-                        {destRect.width / 2.0f, destRect.height / 2.0f}, // origin at center
-                        transform.rotation,
-                        sprite.tint
-                    );
-                });
+            // Camera, draw lists and the boid vertex buffer, kept between frames
+            struct State
+            {
+                Camera2D camera = { {0.0f, 0.0f}, {0.0f, 0.0f}, 0.0f, 1.0f };
+                Batch batch;
+                BoidMesh boidMesh;
+            };
+
+            /*
+            * CPU half only, fills the draw lists without touching the GPU. Boids are
+            * looked up in the boid system's grid from its last tick when most of them
+            * were off screen last frame; grid order is scattered in memory, so a
+            * mostly visible flock is faster to scan. The group is also scanned when
+            * boids were spawned or destroyed outside a tick, or before the first one,
+            * since the grid no longer holds every boid.
+            */
+            inline void Build(seecs::ECS& ecs, State& state, boid_system::State& boids, float screenWidth, float screenHeight) {
+                const Rectangle view = GetViewBounds(state.camera, screenWidth, screenHeight);
+                BuildSprites(ecs, state.batch, view);
+
+                const size_t boidCount = ecs.View<Transform, Motion, Boid>().SizeHint();
+                const bool mostlyCulled = (state.batch.stats.boidsCulled*2 > state.batch.stats.boidsDrawn + state.batch.stats.boidsCulled);
+                if (mostlyCulled && (boids.grid.GetPointCount() == boidCount)) {
+                    BuildBoids(boids.grid, boids.soa, state.batch, view);
+                }
+                else {
+                    BuildBoids(ecs, state.batch, view);
+                }
+            }
 
-                // Render boids as triangles
-                auto boidView = ecs.View<Transform, Motion, Boid>();
-                boidView.ForEach([&](seecs::EntityID id, Transform& transform, Motion& motion, Boid&)
+            inline void Update(seecs::ECS& ecs, State& state, boid_system::State& boids) {
                 {
-                    // Calculate triangle points based on velocity direction
-                    Vector2 direction = {motion.velocity.x, motion.velocity.y};
-                    float velLength = sqrtf(direction.x * direction.x + direction.y * direction.y);
-
-                    if (velLength < 0.1f)
-                    {
-                        direction = {0, -1}; // Default upward if not moving
-                    }
-                    else
-                    {
-                        direction.x /= velLength; // Manual Vector2Normalize
-                        direction.y /= velLength;
-                    }
+                    PROFILE_ZONE("render_build");
+                    Build(ecs, state, boids, (float)GetScreenWidth(), (float)GetScreenHeight());
+                }
 
-                    float size = 10.0f;
-                    Vector2 tip = transform.position;
-                    Vector2 left = {
-                        transform.position.x - direction.x * size - direction.y * size * 0.5f,
-                        transform.position.y - direction.y * size + direction.x * size * 0.5f
-                    };
-                    Vector2 right = {
-                        transform.position.x - direction.x * size + direction.y * size * 0.5f,
-                        transform.position.y - direction.y * size - direction.x * size * 0.5f
-                    };
-
-                    // Draw triangle
-                    DrawTriangle(tip, left, right, BLACK);
-                    DrawTriangleLines(tip, left, right, RED);
-                });
+                PROFILE_ZONE("render_submit");
+                BeginMode2D(state.camera);
+                SubmitSprites(state.batch);
+                state.boidMesh.Draw(state.batch.boidVertices);
+                EndMode2D();
             }
         }
 
-        // Collision System - Detects and handles collisions
+        // Collision System - Detects overlapping colliders and publishes collision events
         namespace collision_system {
-            inline void Update(seecs::ECS& ecs) {
-                auto view = ecs.View<Transform, Collider>();
-                auto entities = view.GetPacked();
-
-                // Check collisions between all pairs of entities
-                for (size_t i = 0; i < entities.size(); ++i) {
-                    for (size_t j = i + 1; j < entities.size(); ++j) {
-                        auto& pack1 = entities[i];
-                        auto& pack2 = entities[j];
-
-                        seecs::EntityID id1 = pack1.id;
-                        seecs::EntityID id2 = pack2.id;
-
-                        auto& [transform1, collider1] = pack1.components;
-                        auto& [transform2, collider2] = pack2.components;
-
-                        Rectangle rect1 = {
-                            transform1.position.x - collider1.bounds.width / 2.0f,
-                            transform1.position.y - collider1.bounds.height / 2.0f,
-                            collider1.bounds.width,
-                            collider1.bounds.height
-                        };
-
-                        Rectangle rect2 = {
-                            transform2.position.x - collider2.bounds.width / 2.0f,
-                            transform2.position.y - collider2.bounds.height / 2.0f,
-                            collider2.bounds.width,
-                            collider2.bounds.height
-                        };
-
-                        if (CheckCollisionRecs(rect1, rect2)) {
-                            // Handle collision - for now just print
-                            // In a real game, you'd dispatch collision events
-                            std::cout << "Collision detected between entities " << static_cast<unsigned long long>(id1) << " and " << static_cast<unsigned long long>(id2) << std::endl;
-                        }
+            // Broad phase proxies and gather buffers, kept between ticks
+            struct State
+            {
+                BroadPhase broadPhase;
+                std::vector<seecs::EntityID> ids;
+                std::vector<Rectangle> rects;
+                std::vector<seecs::EntityID> triggers; // Sorted IDs of trigger colliders
+                std::vector<CollisionPair> pairs;
+                std::vector<CollisionEvent> active;    // Pairs overlapping last tick, sorted
+                std::vector<CollisionEvent> next;
+            };
+
+            /*
+            * Publishes Begin for new pairs, Stay for pairs that still overlap and
+            * End for pairs from last tick that don't anymore. Both the broad phase
+            * output and the active list are sorted, so one merge finds all three.
+            */
+            inline void Update(seecs::ECS& ecs, EventBus& bus, State& state) {
+                state.ids.clear();
+                state.rects.clear();
+                state.triggers.clear();
+
+                ecs.View<Transform, Collider>().Each([&](seecs::EntityID id, Transform& transform, Collider& collider) {
+                    state.ids.push_back(id);
+                    state.rects.push_back({
+                        transform.position.x - collider.bounds.width / 2.0f,
+                        transform.position.y - collider.bounds.height / 2.0f,
+                        collider.bounds.width,
+                        collider.bounds.height
+                    });
+                    if (collider.isTrigger) state.triggers.push_back(id);
+                });
+
+                state.broadPhase.FindPairs(state.ids.data(), state.rects.data(), state.ids.size(), state.pairs);
+                std::sort(state.triggers.begin(), state.triggers.end());
+
+                auto isTrigger = [&](seecs::EntityID id) {
+                    return std::binary_search(state.triggers.begin(), state.triggers.end(), id);
+                };
+                auto before = [](const CollisionEvent& event, const CollisionPair& pair) {
+                    return (event.first != pair.first)? (event.first < pair.first) : (event.second < pair.second);
+                };
+
+                EventQueue<CollisionEvent>& queue = bus.Get<CollisionEvent>();
+                state.next.clear();
+                size_t previous = 0;
+
+                for (const CollisionPair& pair : state.pairs) {
+                    while (previous < state.active.size() && before(state.active[previous], pair)) {
+                        CollisionEvent ended = state.active[previous++];
+                        ended.phase = CollisionPhase::End;
+                        queue.Publish(ended);
                     }
+
+                    bool stay = (previous < state.active.size()) && !before(state.active[previous], pair) &&
+                                (state.active[previous].first == pair.first) && (state.active[previous].second == pair.second);
+                    if (stay) previous++;
+
+                    CollisionEvent event = { pair.first, pair.second, stay? CollisionPhase::Stay : CollisionPhase::Begin,
+                                             isTrigger(pair.first) || isTrigger(pair.second) };
+                    queue.Publish(event);
+                    state.next.push_back(event);
+                }
+
+                for (; previous < state.active.size(); previous++) {
+                    CollisionEvent ended = state.active[previous];
+                    ended.phase = CollisionPhase::End;
+                    queue.Publish(ended);
                 }
+
+                state.active.swap(state.next);
             }
         }
 
         // Health System - Manages health regeneration and death
         namespace health_system {
-            inline void Update(seecs::ECS& ecs, float deltaTime) {
+            // Queues dead entities for deletion, they go when the stage's commands are played back
+            inline void Update(seecs::ECS& ecs, EventBus& bus, CommandQueue& commands, float deltaTime) {
+                CommandBuffer& buffer = commands.Local();
+                EventQueue<DeathEvent>& queue = bus.Get<DeathEvent>();
+
                 auto view = ecs.View<Health>();
-                view.ForEach([&](seecs::EntityID id, Health& health) {
+                view.Each([&](seecs::EntityID id, Health& health) {
                     // Simple health regeneration (1 HP per second)
                     if (health.current < health.max) {
                         health.current = std::min(health.max, health.current + (int)(deltaTime * 10.0f));
@@ -338,18 +278,46 @@ namespace seecs
 
                     // Check for death
                     if (health.current <= 0) {
-                        // In a real game, you'd mark entity for deletion
-                        std::cout << "Entity died!" << std::endl;
+                        queue.Publish({id});
+                        buffer.DeleteEntity(id);
                     }
                 });
             }
         }
 
+        // Event Log System - Prints collision and death events through a rate-limited sink
+        namespace event_log_system {
+            struct State
+            {
+                std::unique_ptr<AsyncLogSink> sink; // Logging is off while null
+                EventQueue<CollisionEvent>::Reader collisions;
+                EventQueue<DeathEvent>::Reader deaths;
+            };
+
+            inline void Update(EventBus& bus, State& state) {
+                if (!state.sink) return;
+                PROFILE_ZONE("event_log");
+
+                bus.Get<CollisionEvent>().Read(state.collisions, [&](const CollisionEvent& event) {
+                    if (event.phase == CollisionPhase::Stay) return;
+
+                    std::string line = (event.phase == CollisionPhase::Begin)? "Collision began between entities " : "Collision ended between entities ";
+                    line += std::to_string(event.first) + " and " + std::to_string(event.second);
+                    if (event.isTrigger) line += " (trigger)";
+                    state.sink->Submit(std::move(line));
+                });
+
+                bus.Get<DeathEvent>().Read(state.deaths, [&](const DeathEvent& event) {
+                    state.sink->Submit("Entity " + std::to_string(event.id) + " died!");
+                });
+            }
+        }
+
         // Player Input System - Handles player-controlled entities
         namespace player_input_system {
             inline void Update(seecs::ECS& ecs, float deltaTime) {
                 auto view = ecs.View<Transform, Motion, PlayerControlled>();
-                view.ForEach([&](seecs::EntityID id, Transform& transform, Motion& motion, PlayerControlled&) {
+                view.Each([&](seecs::EntityID id, Transform& transform, Motion& motion, PlayerControlled&) {
                     // Reset acceleration
                     motion.acceleration = {0.0f, 0.0f};
 
@@ -382,7 +350,7 @@ namespace seecs
         namespace ai_system {
             inline void Update(seecs::ECS& ecs, float deltaTime) {
                 auto view = ecs.View<Transform, Motion, AIControlled>();
-                view.ForEach([&](seecs::EntityID id, Transform& transform, Motion& motion, AIControlled&) {
+                view.Each([&](seecs::EntityID id, Transform& transform, Motion& motion, AIControlled&) {
                     // Simple wandering AI
                     static float aiTimer = 0.0f;
                     aiTimer += deltaTime;
@@ -405,20 +373,107 @@ namespace seecs
         class SystemManager {
         private:
             seecs::ECS& m_ecs;
+            JobSystem& m_jobs;
+            SystemScheduler m_scheduler;
+            CommandQueue m_commands;
+            boid_system::State m_boidState;
+            collision_system::State m_collisionState;
+            event_log_system::State m_eventLogState;
+            render_system::State m_renderState;
+            EventBus m_events;
+            Vector2 m_boidTarget = {0.0f, 0.0f};
 
         public:
-            SystemManager(seecs::ECS& ecs) : m_ecs(ecs) {}
+            SystemManager(seecs::ECS& ecs, JobSystem& jobs) : m_ecs(ecs), m_jobs(jobs), m_commands(jobs)
+            {
+                // Boid and render systems join these three every tick, keep them packed
+                m_ecs.Group<Transform, Motion, Boid>();
+
+                // Event queues are preallocated, a frame publishing more overwrites its oldest events
+                m_events.Register<CollisionEvent>(1 << 16);
+                m_events.Register<DeathEvent>(1 << 12);
+
+                // Registration order is the order conflicting systems run in
+                m_scheduler.Add("movement", SystemAccess(m_ecs).Write<Transform, Motion>(),
+                    [this](float dt) { movement_system::Update(m_ecs, m_jobs, dt); });
+
+                m_scheduler.Add("boid", SystemAccess(m_ecs).Read<Transform, Boid>().Write<Motion>(),
+                    [this](float dt) { boid_system::Update(m_ecs, m_jobs, m_boidState, m_boidTarget, dt); });
+
+                m_scheduler.Add("collision", SystemAccess(m_ecs).Read<Transform, Collider>(),
+                    [this](float) { collision_system::Update(m_ecs, m_events, m_collisionState); });
+
+                m_scheduler.Add("health", SystemAccess(m_ecs).Write<Health>(),
+                    [this](float dt) { health_system::Update(m_ecs, m_events, m_commands, dt); });
+            }
 
             void Update(float deltaTime) {
-                // Update systems in order
-                movement_system::Update(m_ecs, deltaTime);
-                boid_system::Update(m_ecs, deltaTime);
-                collision_system::Update(m_ecs);
-                health_system::Update(m_ecs, deltaTime);
+                PROFILE_ZONE("update");
+                m_events.BeginFrame();
+                m_scheduler.Run(m_jobs, deltaTime, m_ecs, m_commands);
+                event_log_system::Update(m_events, m_eventLogState);
+            }
+
+            /**
+             * @brief Print collision and death events, at most maxLinesPerSecond lines a second
+             *
+             * Only events published after this call are printed. 0 turns logging off.
+             */
+            void SetEventLog(size_t maxLinesPerSecond) {
+                if (maxLinesPerSecond == 0) {
+                    m_eventLogState.sink.reset();
+                    return;
+                }
+
+                m_eventLogState.sink = std::make_unique<AsyncLogSink>(maxLinesPerSecond);
+                m_eventLogState.collisions = m_events.Get<CollisionEvent>().MakeReader();
+                m_eventLogState.deaths = m_events.Get<DeathEvent>().MakeReader();
+            }
+
+            EventBus& GetEvents() {
+                return m_events;
+            }
+
+            // Point boids steer towards, set before every Update()
+            void SetBoidTarget(Vector2 target) {
+                m_boidTarget = target;
+            }
+
+            void SetBoidWeights(const boid_system::BoidWeights& weights) {
+                m_boidState.weights = weights;
+            }
+
+            void SetBruteForceNeighbors(bool enabled) {
+                m_boidState.bruteForceNeighbors = enabled;
+            }
+
+            void SetCollisionBroadPhase(BroadPhaseMode mode) {
+                m_collisionState.broadPhase.SetMode(mode);
+            }
+
+            const SystemScheduler& GetScheduler() const {
+                return m_scheduler;
+            }
+
+            // World view drawn by Render(), culling follows it
+            void SetCamera(const Camera2D& camera) {
+                m_renderState.camera = camera;
+            }
+
+            const Camera2D& GetCamera() const {
+                return m_renderState.camera;
             }
 
             void Render() {
-                render_system::Update(m_ecs);
+                PROFILE_ZONE("render");
+                render_system::Update(m_ecs, m_renderState, m_boidState);
+            }
+
+            // Builds the draw lists for a screen of the given size without drawing them, for timing headless runs
+            const render_system::Batch& BuildRenderBatch(float screenWidth, float screenHeight) {
+                PROFILE_ZONE("render_build");
+                render_system::Build(m_ecs, m_renderState, m_boidState, screenWidth, screenHeight);
+                return m_renderState.batch;
             }
         };
     }
@@ -0,0 +1,607 @@
+#pragma once
+
+#include "raylib.h"
+#include "seecs.h"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+namespace seecs
+{
+    /**
+     * @brief Algorithm used to find overlapping collider pairs
+     */
+    enum class BroadPhaseMode
+    {
+        SweepAndPrune, // Dense worlds where boxes move a little every tick
+        AABBTree,      // Large sparse worlds where many boxes share an x range
+        BruteForce     // All pairs, reference for the other two
+    };
+
+    inline const char* GetBroadPhaseName(BroadPhaseMode mode)
+    {
+        switch (mode)
+        {
+            case BroadPhaseMode::SweepAndPrune: return "sweep and prune";
+            case BroadPhaseMode::AABBTree: return "AABB tree";
+            default: return "brute force";
+        }
+    }
+
+    struct CollisionPair
+    {
+        EntityID first;  // Always the lower ID
+        EntityID second;
+
+        bool operator<(const CollisionPair& other) const
+        {
+            return (first != other.first)? (first < other.first) : (second < other.second);
+        }
+
+        bool operator==(const CollisionPair& other) const = default;
+    };
+
+    // Same test as CheckCollisionRecs(), touching edges don't overlap
+    inline bool RectsOverlap(const Rectangle& a, const Rectangle& b)
+    {
+        return (a.x < (b.x + b.width)) && ((a.x + a.width) > b.x) &&
+               (a.y < (b.y + b.height)) && ((a.y + a.height) > b.y);
+    }
+
+    inline CollisionPair MakePair(EntityID a, EntityID b)
+    {
+        return (a < b)? CollisionPair{a, b} : CollisionPair{b, a};
+    }
+
+    /**
+     * @brief Sweep and prune on the x axis with a persistent sort order
+     *
+     * Boxes are kept sorted by their left edge between ticks and re-sorted with
+     * an insertion sort, which is close to linear when objects move little per
+     * tick. The sweep then only tests boxes whose x ranges overlap.
+     */
+    class SweepAndPrune
+    {
+    public:
+        /**
+         * @brief Sync the proxies with this tick's boxes
+         *
+         * Entities missing from ids lose their proxy, new ones get one.
+         */
+        void Update(const EntityID* ids, const Rectangle* rects, size_t count)
+        {
+            m_stamp++;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                auto [it, inserted] = m_proxyOf.try_emplace(ids[i], 0);
+                if (inserted)
+                {
+                    it->second = AllocateProxy(ids[i]);
+                    m_order.push_back({rects[i].x, it->second});
+                }
+
+                Proxy& proxy = m_proxies[it->second];
+                proxy.rect = rects[i];
+                proxy.stamp = m_stamp;
+            }
+
+            // Drop stale proxies, erasing keeps the rest in sorted order
+            if (m_proxyOf.size() > count)
+            {
+                m_order.erase(std::remove_if(m_order.begin(), m_order.end(), [&](const Endpoint& endpoint)
+                {
+                    Proxy& proxy = m_proxies[endpoint.proxy];
+                    if (proxy.stamp == m_stamp) return false;
+
+                    m_proxyOf.erase(proxy.id);
+                    m_freeProxies.push_back(endpoint.proxy);
+                    return true;
+                }), m_order.end());
+            }
+
+            // Refresh the endpoints, then insertion sort them
+            for (Endpoint& endpoint : m_order) endpoint.minX = m_proxies[endpoint.proxy].rect.x;
+
+            for (size_t i = 1; i < m_order.size(); i++)
+            {
+                Endpoint endpoint = m_order[i];
+                size_t j = i;
+                while ((j > 0) && (m_order[j - 1].minX > endpoint.minX))
+                {
+                    m_order[j] = m_order[j - 1];
+                    j--;
+                }
+                m_order[j] = endpoint;
+            }
+        }
+
+        /**
+         * @brief Invoke func(pair) once for every overlapping pair
+         */
+        template <typename Func>
+        void ForEachPair(Func&& func) const
+        {
+            for (size_t i = 0; i < m_order.size(); i++)
+            {
+                const Proxy& a = m_proxies[m_order[i].proxy];
+                const float maxX = a.rect.x + a.rect.width;
+
+                // Later boxes start at or after a, they can only overlap until one starts past its right edge
+                for (size_t j = i + 1; (j < m_order.size()) && (m_order[j].minX < maxX); j++)
+                {
+                    const Proxy& b = m_proxies[m_order[j].proxy];
+                    if (RectsOverlap(a.rect, b.rect)) func(MakePair(a.id, b.id));
+                }
+            }
+        }
+
+        void Clear()
+        {
+            m_proxies.clear();
+            m_freeProxies.clear();
+            m_order.clear();
+            m_proxyOf.clear();
+        }
+
+    private:
+        struct Proxy
+        {
+            EntityID id = NULL_ENTITY;
+            Rectangle rect = {0, 0, 0, 0};
+            uint32_t stamp = 0;
+        };
+
+        struct Endpoint
+        {
+            float minX;
+            uint32_t proxy;
+        };
+
+        std::vector<Proxy> m_proxies;
+        std::vector<uint32_t> m_freeProxies;
+        std::vector<Endpoint> m_order;  // Sorted by left edge
+        std::unordered_map<EntityID, uint32_t> m_proxyOf;
+        uint32_t m_stamp = 0;
+
+        uint32_t AllocateProxy(EntityID id)
+        {
+            uint32_t index;
+            if (!m_freeProxies.empty())
+            {
+                index = m_freeProxies.back();
+                m_freeProxies.pop_back();
+            }
+            else
+            {
+                index = (uint32_t)m_proxies.size();
+                m_proxies.emplace_back();
+            }
+
+            m_proxies[index].id = id;
+            return index;
+        }
+    };
+
+    /**
+     * @brief Dynamic bounding volume tree over fattened boxes
+     *
+     * Leaves store the box grown by a margin, so a leaf is only reinserted
+     * when its box leaves the fat box. Inserts pick the sibling with the
+     * cheapest perimeter increase and rotations keep the tree balanced.
+     * Pair queries descend the tree once per box. That costs more than a
+     * sweep on evenly spread boxes, but doesn't degrade when many boxes share
+     * the same x range, like a large world that is tall and narrow.
+     */
+    class DynamicAABBTree
+    {
+    public:
+        explicit DynamicAABBTree(float margin = 4.0f) : m_margin(margin) {}
+
+        /**
+         * @brief Sync the leaves with this tick's boxes
+         *
+         * Entities missing from ids lose their leaf, new ones get one.
+         */
+        void Update(const EntityID* ids, const Rectangle* rects, size_t count)
+        {
+            m_stamp++;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                auto [it, inserted] = m_leafOf.try_emplace(ids[i], NULL_NODE);
+                if (inserted)
+                {
+                    it->second = AllocateNode();
+                    Node& leaf = m_nodes[it->second];
+                    leaf.id = ids[i];
+                    leaf.height = 0;
+                    leaf.box = Fatten(rects[i]);
+                    InsertLeaf(it->second);
+                }
+                else if (!Contains(m_nodes[it->second].box, rects[i]))
+                {
+                    RemoveLeaf(it->second);
+                    m_nodes[it->second].box = Fatten(rects[i]);
+                    InsertLeaf(it->second);
+                }
+
+                Node& leaf = m_nodes[it->second];
+                leaf.rect = rects[i];
+                leaf.stamp = m_stamp;
+            }
+
+            if (m_leafOf.size() > count)
+            {
+                for (auto it = m_leafOf.begin(); it != m_leafOf.end();)
+                {
+                    if (m_nodes[it->second].stamp == m_stamp)
+                    {
+                        ++it;
+                        continue;
+                    }
+
+                    RemoveLeaf(it->second);
+                    FreeNode(it->second);
+                    it = m_leafOf.erase(it);
+                }
+            }
+        }
+
+        /**
+         * @brief Invoke func(pair) once for every overlapping pair
+         */
+        template <typename Func>
+        void ForEachPair(Func&& func) const
+        {
+            // Walk the node array rather than the map, in memory order
+            for (int32_t index = 0; index < (int32_t)m_nodes.size(); index++)
+            {
+                const Node& leaf = m_nodes[index];
+                if (leaf.height != 0) continue;
+
+                Query(leaf.rect, [&](int32_t other)
+                {
+                    // Lower leaf index reports the pair
+                    if (other <= index) return;
+                    if (RectsOverlap(leaf.rect, m_nodes[other].rect)) func(MakePair(leaf.id, m_nodes[other].id));
+                });
+            }
+        }
+
+        /**
+         * @brief Invoke func(leafIndex) for every leaf whose fat box touches rect
+         */
+        template <typename Func>
+        void Query(const Rectangle& rect, Func&& func) const
+        {
+            if (m_root == NULL_NODE) return;
+
+            const Box box = {rect.x, rect.y, rect.x + rect.width, rect.y + rect.height};
+            m_stack.clear();
+            m_stack.push_back(m_root);
+
+            while (!m_stack.empty())
+            {
+                int32_t index = m_stack.back();
+                m_stack.pop_back();
+
+                const Node& node = m_nodes[index];
+                if (!Touches(node.box, box)) continue;
+
+                if (node.IsLeaf())
+                {
+                    func(index);
+                }
+                else
+                {
+                    m_stack.push_back(node.child1);
+                    m_stack.push_back(node.child2);
+                }
+            }
+        }
+
+        void Clear()
+        {
+            m_nodes.clear();
+            m_leafOf.clear();
+            m_root = NULL_NODE;
+            m_freeList = NULL_NODE;
+        }
+
+        int GetHeight() const { return (m_root == NULL_NODE)? 0 : m_nodes[m_root].height; }
+
+    private:
+        static constexpr int32_t NULL_NODE = -1;
+
+        struct Box
+        {
+            float minX, minY, maxX, maxY;
+        };
+
+        struct Node
+        {
+            Box box = {0, 0, 0, 0};     // Fat box for leaves, union of the children otherwise
+            Rectangle rect = {0, 0, 0, 0}; // Exact box, leaves only
+            EntityID id = NULL_ENTITY;
+            int32_t parent = NULL_NODE;  // Next free node while on the free list
+            int32_t child1 = NULL_NODE;
+            int32_t child2 = NULL_NODE;
+            int32_t height = -1;         // 0 for leaves, -1 when free
+            uint32_t stamp = 0;
+
+            bool IsLeaf() const { return child1 == NULL_NODE; }
+        };
+
+        std::vector<Node> m_nodes;
+        std::unordered_map<EntityID, int32_t> m_leafOf;
+        mutable std::vector<int32_t> m_stack; // Query scratch
+        int32_t m_root = NULL_NODE;
+        int32_t m_freeList = NULL_NODE;
+        float m_margin;
+        uint32_t m_stamp = 0;
+
+        static Box Union(const Box& a, const Box& b)
+        {
+            return { std::min(a.minX, b.minX), std::min(a.minY, b.minY), std::max(a.maxX, b.maxX), std::max(a.maxY, b.maxY) };
+        }
+
+        static float Perimeter(const Box& box)
+        {
+            return 2.0f*((box.maxX - box.minX) + (box.maxY - box.minY));
+        }
+
+        // Inclusive, so fat boxes never miss a pair the exact test would report
+        static bool Touches(const Box& a, const Box& b)
+        {
+            return (a.minX <= b.maxX) && (a.maxX >= b.minX) && (a.minY <= b.maxY) && (a.maxY >= b.minY);
+        }
+
+        static bool Contains(const Box& box, const Rectangle& rect)
+        {
+            return (box.minX <= rect.x) && (box.minY <= rect.y) &&
+                   (box.maxX >= rect.x + rect.width) && (box.maxY >= rect.y + rect.height);
+        }
+
+        Box Fatten(const Rectangle& rect) const
+        {
+            return { rect.x - m_margin, rect.y - m_margin, rect.x + rect.width + m_margin, rect.y + rect.height + m_margin };
+        }
+
+        int32_t AllocateNode()
+        {
+            int32_t index;
+            if (m_freeList != NULL_NODE)
+            {
+                index = m_freeList;
+                m_freeList = m_nodes[index].parent;
+                m_nodes[index] = Node();
+            }
+            else
+            {
+                index = (int32_t)m_nodes.size();
+                m_nodes.emplace_back();
+            }
+
+            return index;
+        }
+
+        void FreeNode(int32_t index)
+        {
+            m_nodes[index].parent = m_freeList;
+            m_nodes[index].height = -1;
+            m_freeList = index;
+        }
+
+        void InsertLeaf(int32_t leaf)
+        {
+            if (m_root == NULL_NODE)
+            {
+                m_root = leaf;
+                m_nodes[leaf].parent = NULL_NODE;
+                return;
+            }
+
+            // Walk down to the sibling whose union with the leaf costs the least perimeter
+            const Box leafBox = m_nodes[leaf].box;
+            int32_t index = m_root;
+            while (!m_nodes[index].IsLeaf())
+            {
+                const Node& node = m_nodes[index];
+                float combined = Perimeter(Union(node.box, leafBox));
+
+                // Pairing with this node costs its new parent, descending also grows this node
+                float cost = 2.0f*combined;
+                float inheritance = 2.0f*(combined - Perimeter(node.box));
+
+                float costs[2];
+                int32_t children[2] = { node.child1, node.child2 };
+                for (int c = 0; c < 2; c++)
+                {
+                    const Node& child = m_nodes[children[c]];
+                    float grown = Perimeter(Union(child.box, leafBox));
+                    costs[c] = (child.IsLeaf()? grown : (grown - Perimeter(child.box))) + inheritance;
+                }
+
+                if ((cost < costs[0]) && (cost < costs[1])) break;
+                index = (costs[0] < costs[1])? children[0] : children[1];
+            }
+
+            // Replace the sibling with a new parent of the sibling and the leaf
+            int32_t sibling = index;
+            int32_t newParent = AllocateNode();
+            int32_t oldParent = m_nodes[sibling].parent;
+
+            Node& parent = m_nodes[newParent];
+            parent.parent = oldParent;
+            parent.box = Union(leafBox, m_nodes[sibling].box);
+            parent.height = m_nodes[sibling].height + 1;
+            parent.child1 = sibling;
+            parent.child2 = leaf;
+            m_nodes[sibling].parent = newParent;
+            m_nodes[leaf].parent = newParent;
+
+            if (oldParent == NULL_NODE) m_root = newParent;
+            else if (m_nodes[oldParent].child1 == sibling) m_nodes[oldParent].child1 = newParent;
+            else m_nodes[oldParent].child2 = newParent;
+
+            Refit(m_nodes[leaf].parent);
+        }
+
+        void RemoveLeaf(int32_t leaf)
+        {
+            if (leaf == m_root)
+            {
+                m_root = NULL_NODE;
+                return;
+            }
+
+            int32_t parent = m_nodes[leaf].parent;
+            int32_t grandParent = m_nodes[parent].parent;
+            int32_t sibling = (m_nodes[parent].child1 == leaf)? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+            // The sibling takes the parent's place
+            m_nodes[sibling].parent = grandParent;
+            if (grandParent == NULL_NODE) m_root = sibling;
+            else if (m_nodes[grandParent].child1 == parent) m_nodes[grandParent].child1 = sibling;
+            else m_nodes[grandParent].child2 = sibling;
+
+            FreeNode(parent);
+            Refit(grandParent);
+        }
+
+        // Rebalance and recompute boxes and heights from index up to the root
+        void Refit(int32_t index)
+        {
+            while (index != NULL_NODE)
+            {
+                index = Balance(index);
+
+                Node& node = m_nodes[index];
+                const Node& child1 = m_nodes[node.child1];
+                const Node& child2 = m_nodes[node.child2];
+                node.height = 1 + std::max(child1.height, child2.height);
+                node.box = Union(child1.box, child2.box);
+
+                index = node.parent;
+            }
+        }
+
+        /**
+         * @brief Rotate the taller child of a up if the heights differ by more than one
+         * @return Index of the node now at a's place
+         */
+        int32_t Balance(int32_t a)
+        {
+            Node& nodeA = m_nodes[a];
+            if (nodeA.IsLeaf() || (nodeA.height < 2)) return a;
+
+            int32_t b = nodeA.child1;
+            int32_t c = nodeA.child2;
+            int32_t balance = m_nodes[c].height - m_nodes[b].height;
+
+            if (balance > 1) return Rotate(a, c, b, false);
+            if (balance < -1) return Rotate(a, b, c, true);
+            return a;
+        }
+
+        // Moves up the child of a, the other child stays under a. upIsChild1 says which slot up was in.
+        int32_t Rotate(int32_t a, int32_t up, int32_t stay, bool upIsChild1)
+        {
+            Node& nodeA = m_nodes[a];
+            Node& nodeUp = m_nodes[up];
+            int32_t f = nodeUp.child1;
+            int32_t g = nodeUp.child2;
+
+            // up takes a's place and a becomes up's first child
+            nodeUp.child1 = a;
+            nodeUp.parent = nodeA.parent;
+            nodeA.parent = up;
+
+            if (nodeUp.parent == NULL_NODE) m_root = up;
+            else if (m_nodes[nodeUp.parent].child1 == a) m_nodes[nodeUp.parent].child1 = up;
+            else m_nodes[nodeUp.parent].child2 = up;
+
+            // The taller grandchild stays under up, the shorter one moves into a
+            int32_t keep = (m_nodes[f].height > m_nodes[g].height)? f : g;
+            int32_t move = (keep == f)? g : f;
+
+            nodeUp.child2 = keep;
+            if (upIsChild1) nodeA.child1 = move;
+            else nodeA.child2 = move;
+            m_nodes[move].parent = a;
+
+            nodeA.box = Union(m_nodes[stay].box, m_nodes[move].box);
+            nodeA.height = 1 + std::max(m_nodes[stay].height, m_nodes[move].height);
+            nodeUp.box = Union(nodeA.box, m_nodes[keep].box);
+            nodeUp.height = 1 + std::max(nodeA.height, m_nodes[keep].height);
+
+            return up;
+        }
+    };
+
+    /**
+     * @brief Finds overlapping collider pairs with the selected algorithm
+     *
+     * Every mode reports the same pairs as testing all of them with
+     * CheckCollisionRecs(), sorted by entity ID so the order doesn't depend
+     * on the mode either.
+     */
+    class BroadPhase
+    {
+    public:
+        void SetMode(BroadPhaseMode mode)
+        {
+            if (mode == m_mode) return;
+
+            // Proxies of the old mode would go stale, rebuild from scratch on the next update
+            m_sweep.Clear();
+            m_tree.Clear();
+            m_mode = mode;
+        }
+
+        BroadPhaseMode GetMode() const { return m_mode; }
+
+        /**
+         * @brief Find every overlapping pair among this tick's boxes
+         * @param pairs Receives the pairs, cleared first
+         */
+        void FindPairs(const EntityID* ids, const Rectangle* rects, size_t count, std::vector<CollisionPair>& pairs)
+        {
+            pairs.clear();
+            auto emit = [&pairs](CollisionPair pair) { pairs.push_back(pair); };
+
+            switch (m_mode)
+            {
+                case BroadPhaseMode::SweepAndPrune:
+                {
+                    m_sweep.Update(ids, rects, count);
+                    m_sweep.ForEachPair(emit);
+                } break;
+                case BroadPhaseMode::AABBTree:
+                {
+                    m_tree.Update(ids, rects, count);
+                    m_tree.ForEachPair(emit);
+                } break;
+                default:
+                {
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        for (size_t j = i + 1; j < count; j++)
+                        {
+                            if (RectsOverlap(rects[i], rects[j])) emit(MakePair(ids[i], ids[j]));
+                        }
+                    }
+                } break;
+            }
+
+            std::sort(pairs.begin(), pairs.end());
+        }
+
+    private:
+        BroadPhaseMode m_mode = BroadPhaseMode::SweepAndPrune;
+        SweepAndPrune m_sweep;
+        DynamicAABBTree m_tree;
+    };
+}
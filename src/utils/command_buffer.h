@@ -0,0 +1,464 @@
+#pragma once
+
+#include "seecs.h"
+#include "frame_arena.h"
+#include "job_system.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace seecs
+{
+    /**
+     * @brief Entity created by a CommandBuffer, it gets its ID on playback
+     */
+    struct PendingEntity
+    {
+        uint32_t index = 0; // Position among the buffer's creates
+    };
+
+    /**
+     * @brief Records structural changes to apply to an ECS later, in one go
+     *
+     * Systems running in parallel can't create or delete entities or add and
+     * remove components, since that moves the pools other systems iterate.
+     * They record the changes here instead and a single Playback() applies
+     * them once nothing iterates the world any more.
+     *
+     * Component payloads are moved into a FrameArena, so recording doesn't
+     * allocate once the arena and the command list have grown to a stage's
+     * worth of commands. The buffer runs the payloads' destructors itself.
+     *
+     * Playback applies every create first, then the adds and removes grouped
+     * by component pool and sorted by entity, then the deletes as one
+     * DestroyEntities() call. The end result is the same as applying the
+     * commands in recording order: of several adds and removes of the same
+     * component on one entity, only the last one recorded takes effect.
+     * Commands on entities dead by then are dropped.
+     *
+     * Not thread safe, every thread records into its own buffer, see CommandQueue.
+     */
+    class CommandBuffer
+    {
+    public:
+        explicit CommandBuffer(size_t arenaBytes = 16 * 1024) : m_arena(arenaBytes) {}
+        ~CommandBuffer() { Clear(); }
+
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+        /**
+         * @brief Create an entity on playback, components can be added to it right away
+         */
+        PendingEntity CreateEntity()
+        {
+            PendingEntity entity = { m_createCount++ };
+            m_commands.push_back({ Op::Create, true, entity.index, 0, NextSequence(), nullptr, nullptr });
+            return entity;
+        }
+
+        template <typename T>
+        void Add(EntityID id, T component = {})
+        {
+            Record<T>(Op::Add, false, id, std::move(component));
+        }
+
+        template <typename T>
+        void Add(PendingEntity entity, T component = {})
+        {
+            Record<T>(Op::Add, true, entity.index, std::move(component));
+        }
+
+        /**
+         * @brief Remove T from id on playback, if it still has one by then
+         */
+        template <typename T>
+        void Remove(EntityID id)
+        {
+            m_commands.push_back({ Op::Remove, false, id, TypeIdOf<T>, NextSequence(), nullptr, &OpsOf<T>() });
+        }
+
+        /**
+         * @brief Delete id on playback, deleting it more than once is fine
+         */
+        void DeleteEntity(EntityID id)
+        {
+            m_commands.push_back({ Op::Delete, false, id, 0, NextSequence(), nullptr, nullptr });
+        }
+
+        size_t Size() const { return m_commands.size(); }
+        bool Empty() const { return m_commands.empty(); }
+
+        /**
+         * @brief Apply every recorded command to ecs and clear the buffer
+         */
+        void Playback(ECS& ecs)
+        {
+            CommandBuffer* self = this;
+            Apply(ecs, std::span<CommandBuffer* const>(&self, 1), m_playback);
+        }
+
+        /**
+         * @brief Drop every recorded command without applying it
+         */
+        void Clear()
+        {
+            for (Command& command : m_commands)
+            {
+                if (command.payload) command.ops->destroy(command.payload);
+            }
+
+            m_commands.clear();
+            m_created.clear();
+            m_createCount = 0;
+            m_arena.Reset();
+        }
+
+    private:
+        friend class CommandQueue;
+
+        enum class Op : uint8_t { Create, Add, Remove, Delete };
+
+        // Type-erased calls into the ECS for one component type
+        struct ComponentOps
+        {
+            void (*add)(ECS& ecs, EntityID id, void* payload);
+            void (*remove)(ECS& ecs, EntityID id);
+            void (*destroy)(void* payload);
+            ISparseSet* (*pool)(ECS& ecs);
+        };
+
+        struct Command
+        {
+            Op op;
+            bool pending;           // entity is an index into m_created
+            EntityID entity;
+            ComponentTypeID type;   // Add and Remove only
+            uint64_t sequence;      // Recording order, across every buffer sharing m_sequence
+            void* payload;          // Add only, lives in m_arena
+            const ComponentOps* ops;
+        };
+
+        // A command with its entity resolved, sorted for playback
+        struct Entry
+        {
+            EntityID entity;
+            uint32_t group; // Index into the playback's Group list
+            Command* command;
+        };
+
+        // Adds and removes on one pool, or all the deletes: the unit playback sorts and applies
+        struct Group
+        {
+            bool deletes;
+            ComponentTypeID type;
+            size_t count;
+            size_t begin; // First entry in the sorted list
+        };
+
+        // Scratch reused between playbacks
+        struct PlaybackState
+        {
+            std::vector<Entry> entries;
+            std::vector<Entry> sorted;
+            std::vector<Entry> scratch;
+            std::vector<Group> groups;
+            std::vector<uint32_t> order;
+            std::vector<EntityID> deleted;
+        };
+
+        std::vector<Command> m_commands;
+        std::vector<EntityID> m_created; // IDs given to the creates, filled on playback
+        uint32_t m_createCount = 0;
+        FrameArena m_arena;
+
+        // A CommandQueue points every buffer at one counter, so commands
+        // recorded by different threads can still be ordered
+        std::atomic<uint64_t> m_ownSequence = 0;
+        std::atomic<uint64_t>* m_sequence = &m_ownSequence;
+
+        PlaybackState m_playback; // Only used by Playback() on this buffer alone
+
+        template <typename T>
+        static const ComponentOps& OpsOf()
+        {
+            static constexpr ComponentOps ops = {
+                [](ECS& ecs, EntityID id, void* payload)
+                {
+                    T* component = static_cast<T*>(payload);
+                    ecs.Add<T>(id, std::move(*component));
+                    component->~T();
+                },
+                [](ECS& ecs, EntityID id) { ecs.Remove<T>(id); },
+                [](void* payload) { static_cast<T*>(payload)->~T(); },
+                [](ECS& ecs) { return ecs.GetViewPoolPtr<T>(); }
+            };
+            return ops;
+        }
+
+        uint64_t NextSequence()
+        {
+            return m_sequence->fetch_add(1, std::memory_order_relaxed);
+        }
+
+        template <typename T>
+        void Record(Op op, bool pending, EntityID entity, T&& component)
+        {
+            static_assert(std::is_move_constructible_v<T>, "Components recorded into a CommandBuffer must be movable");
+            void* payload = new (m_arena.Allocate(sizeof(T), alignof(T))) T(std::move(component));
+            m_commands.push_back({ op, pending, entity, TypeIdOf<T>, NextSequence(), payload, &OpsOf<T>() });
+        }
+
+        static uint32_t FindGroup(std::vector<Group>& groups, bool deletes, ComponentTypeID type, uint32_t hint)
+        {
+            // Consecutive commands are usually on the same pool
+            if (hint < groups.size() && groups[hint].deletes == deletes && groups[hint].type == type) return hint;
+
+            for (uint32_t g = 0; g < groups.size(); g++)
+            {
+                if (groups[g].deletes == deletes && groups[g].type == type) return g;
+            }
+
+            groups.push_back({ deletes, type, 0, 0 });
+            return (uint32_t)(groups.size() - 1);
+        }
+
+        /**
+         * @brief Stable sort of entries by entity
+         *
+         * LSD radix sort, 11 bits a pass. Passes on a digit every entity shares
+         * are skipped, the high bits of the index and the version mostly are.
+         */
+        static void SortByEntity(Entry* entries, size_t count, std::vector<Entry>& scratch)
+        {
+            constexpr uint32_t RADIX_BITS = 11;
+            constexpr uint32_t BUCKETS = 1u << RADIX_BITS;
+
+            if (count < 2) return;
+            scratch.resize(count);
+
+            Entry* from = entries;
+            Entry* to = scratch.data();
+            uint32_t counts[BUCKETS];
+
+            for (uint32_t shift = 0; shift < 32; shift += RADIX_BITS)
+            {
+                std::fill(counts, counts + BUCKETS, 0u);
+                for (size_t i = 0; i < count; i++) counts[(from[i].entity >> shift) & (BUCKETS - 1)]++;
+                if (counts[(from[0].entity >> shift) & (BUCKETS - 1)] == count) continue;
+
+                uint32_t offset = 0;
+                for (uint32_t& bucket : counts)
+                {
+                    uint32_t size = bucket;
+                    bucket = offset;
+                    offset += size;
+                }
+
+                for (size_t i = 0; i < count; i++) to[counts[(from[i].entity >> shift) & (BUCKETS - 1)]++] = from[i];
+                std::swap(from, to);
+            }
+
+            if (from != entries) std::copy(from, from + count, entries);
+        }
+
+        static void Apply(ECS& ecs, std::span<CommandBuffer* const> buffers, PlaybackState& state)
+        {
+            state.entries.clear();
+            state.groups.clear();
+            state.deleted.clear();
+
+            // Creates are applied first and in recording order, the other commands need their IDs
+            size_t createCount = 0;
+            for (CommandBuffer* buffer : buffers) createCount += buffer->m_createCount;
+
+            if (createCount > 0)
+            {
+                std::span<const EntityID> created = ecs.CreateEntities(createCount);
+                for (CommandBuffer* buffer : buffers)
+                {
+                    buffer->m_created.assign(created.begin(), created.begin() + buffer->m_createCount);
+                    created = created.subspan(buffer->m_createCount);
+                }
+            }
+
+            uint32_t hint = 0;
+            for (CommandBuffer* buffer : buffers)
+            {
+                for (Command& command : buffer->m_commands)
+                {
+                    if (command.op == Op::Create) continue;
+
+                    EntityID entity = command.pending ? buffer->m_created[command.entity] : command.entity;
+                    hint = FindGroup(state.groups, command.op == Op::Delete, command.type, hint);
+                    state.groups[hint].count++;
+                    state.entries.push_back({ entity, hint, &command });
+                }
+            }
+
+            // Counting sort by pool, deletes last: there are only a handful of groups
+            state.order.resize(state.groups.size());
+            for (uint32_t g = 0; g < state.groups.size(); g++) state.order[g] = g;
+            std::sort(state.order.begin(), state.order.end(), [&](uint32_t a, uint32_t b)
+            {
+                const Group& first = state.groups[a];
+                const Group& second = state.groups[b];
+                return (first.deletes != second.deletes) ? second.deletes : first.type < second.type;
+            });
+
+            size_t offset = 0;
+            for (uint32_t g : state.order)
+            {
+                state.groups[g].begin = offset;
+                offset += state.groups[g].count;
+            }
+
+            state.sorted.resize(state.entries.size());
+            for (const Entry& entry : state.entries) state.sorted[state.groups[entry.group].begin++] = entry;
+
+            size_t begin = 0;
+            for (uint32_t g : state.order)
+            {
+                const Group& group = state.groups[g];
+                const auto first = state.sorted.begin() + begin;
+                const auto last = first + group.count;
+                begin += group.count;
+
+                // Entity order makes the result independent of which thread
+                // recorded what, and walks the sparse pages in order
+                auto byEntity = [](const Entry& a, const Entry& b) { return a.entity < b.entity; };
+                if (!std::is_sorted(first, last, byEntity)) SortByEntity(&*first, group.count, state.scratch);
+
+                if (group.deletes)
+                {
+                    for (auto it = first; it != last; ++it)
+                    {
+                        if (ecs.IsAlive(it->entity)) state.deleted.push_back(it->entity);
+                    }
+                    continue;
+                }
+
+                // One growth for the whole group instead of one per doubling
+                if (ISparseSet* pool = first->command->ops->pool(ecs))
+                {
+                    size_t needed = pool->Size() + group.count;
+                    size_t capacity = pool->Entities().capacity();
+                    if (needed > capacity) pool->Reserve(std::max(needed, capacity * 2));
+                }
+
+                for (auto it = first; it != last;)
+                {
+                    // Of the commands on one entity only the last recorded counts,
+                    // the payloads of the adds it overrides are dropped
+                    auto runEnd = it + 1;
+                    Command* latest = it->command;
+                    for (; runEnd != last && runEnd->entity == it->entity; ++runEnd)
+                    {
+                        if (runEnd->command->sequence > latest->sequence) latest = runEnd->command;
+                    }
+
+                    bool alive = ecs.IsAlive(it->entity);
+                    for (auto run = it; run != runEnd; ++run)
+                    {
+                        Command& command = *run->command;
+                        if (&command == latest && alive)
+                        {
+                            if (command.op == Op::Add) command.ops->add(ecs, it->entity, command.payload);
+                            else command.ops->remove(ecs, it->entity);
+                        }
+                        else if (command.payload) command.ops->destroy(command.payload);
+                        command.payload = nullptr;
+                    }
+
+                    it = runEnd;
+                }
+            }
+
+            // Sorted already, only repeats need to go
+            state.deleted.erase(std::unique(state.deleted.begin(), state.deleted.end()), state.deleted.end());
+            if (!state.deleted.empty()) ecs.DestroyEntities(state.deleted);
+
+            for (CommandBuffer* buffer : buffers)
+            {
+                buffer->m_commands.clear();
+                buffer->m_createCount = 0;
+                buffer->m_arena.Reset();
+            }
+        }
+    };
+
+    /**
+     * @brief One CommandBuffer per job system thread, played back together
+     *
+     * Code running on the job system records into Local() without locking.
+     * The buffers share one sequence counter, so where threads record
+     * conflicting adds and removes for one entity, the one recorded last wins.
+     * Playback() goes through the buffers in thread order, so where several
+     * threads create entities in the same stage their IDs depend on which
+     * thread ran what. Everything else is applied in a fixed order.
+     */
+    class CommandQueue
+    {
+    public:
+        explicit CommandQueue(const JobSystem& jobs) : m_jobs(&jobs)
+        {
+            m_buffers.resize(jobs.GetThreadCount());
+            for (std::unique_ptr<CommandBuffer>& buffer : m_buffers)
+            {
+                buffer = std::make_unique<CommandBuffer>();
+                buffer->m_sequence = &m_sequence;
+            }
+            m_pointers.resize(m_buffers.size());
+        }
+
+        /**
+         * @brief Buffer of the calling thread
+         *
+         * Threads outside the job system share buffer 0 with the main thread.
+         */
+        CommandBuffer& Local()
+        {
+            return *m_buffers[m_jobs->GetThreadIndex()];
+        }
+
+        bool Empty() const
+        {
+            for (const std::unique_ptr<CommandBuffer>& buffer : m_buffers)
+            {
+                if (!buffer->Empty()) return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Apply every thread's commands to ecs and clear the buffers
+         *
+         * Nothing may record or iterate ecs while this runs.
+         */
+        void Playback(ECS& ecs)
+        {
+            if (Empty()) return;
+
+            for (size_t i = 0; i < m_buffers.size(); i++) m_pointers[i] = m_buffers[i].get();
+            CommandBuffer::Apply(ecs, m_pointers, m_playback);
+        }
+
+        void Clear()
+        {
+            for (std::unique_ptr<CommandBuffer>& buffer : m_buffers) buffer->Clear();
+        }
+
+    private:
+        const JobSystem* m_jobs;
+        std::vector<std::unique_ptr<CommandBuffer>> m_buffers;
+        std::vector<CommandBuffer*> m_pointers;
+        CommandBuffer::PlaybackState m_playback;
+        std::atomic<uint64_t> m_sequence = 0;
+    };
+}
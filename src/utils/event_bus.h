@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include "seecs.h"
+
+namespace seecs
+{
+    class IEventQueue
+    {
+    public:
+        virtual ~IEventQueue() = default;
+        virtual void BeginFrame() = 0;
+    };
+
+    /**
+     * @brief Preallocated ring buffer of events of one type
+     *
+     * Publishing never allocates: once the buffer is full the oldest events
+     * are overwritten. Readers keep their own cursor and get everything
+     * published since their last read, or are told how many events they
+     * missed if they fell more than a full buffer behind.
+     *
+     * A queue has a single writer at a time. Systems that publish the same
+     * event type must not run in parallel.
+     */
+    template <typename T>
+    class EventQueue : public IEventQueue
+    {
+    public:
+        struct Reader
+        {
+            uint64_t cursor = 0;
+            uint64_t dropped = 0; // Events overwritten before this reader got to them
+        };
+
+        /**
+         * @param capacity Rounded up to a power of two
+         */
+        explicit EventQueue(size_t capacity)
+        {
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            m_events.resize(size);
+            m_mask = size - 1;
+        }
+
+        void Publish(const T& event)
+        {
+            m_events[m_written & m_mask] = event;
+            m_written++;
+        }
+
+        /**
+         * @brief Invoke func(event) for every event published since the reader's last read
+         */
+        template <typename Func>
+        void Read(Reader& reader, Func&& func) const
+        {
+            if (m_written - reader.cursor > m_events.size())
+            {
+                reader.dropped += m_written - m_events.size() - reader.cursor;
+                reader.cursor = m_written - m_events.size();
+            }
+
+            for (; reader.cursor < m_written; reader.cursor++) func(m_events[reader.cursor & m_mask]);
+        }
+
+        /**
+         * @brief Invoke func(event) for every event published since BeginFrame()
+         *
+         * Only the last capacity events are kept if the frame published more.
+         */
+        template <typename Func>
+        void ForEachThisFrame(Func&& func) const
+        {
+            uint64_t first = std::max(m_frameStart, (m_written > m_events.size())? m_written - m_events.size() : 0);
+            for (uint64_t i = first; i < m_written; i++) func(m_events[i & m_mask]);
+        }
+
+        // New readers start here to skip events from before they existed
+        Reader MakeReader() const { return Reader{m_written, 0}; }
+
+        void BeginFrame() override { m_frameStart = m_written; }
+
+        size_t GetCapacity() const { return m_events.size(); }
+        size_t GetFrameCount() const { return (size_t)(m_written - m_frameStart); }
+        uint64_t GetPublishedCount() const { return m_written; }
+
+    private:
+        std::vector<T> m_events;
+        uint64_t m_mask = 0;
+        uint64_t m_written = 0;    // Total events ever published
+        uint64_t m_frameStart = 0; // m_written at the last BeginFrame()
+    };
+
+    /**
+     * @brief Typed per-frame event channels shared between systems
+     *
+     * Register every event type up front, so queues are never created while
+     * systems run on worker threads.
+     */
+    class EventBus
+    {
+    public:
+        template <typename T>
+        EventQueue<T>& Register(size_t capacity)
+        {
+            auto& queue = m_queues[std::type_index(typeid(T))];
+            if (!queue) queue = std::make_unique<EventQueue<T>>(capacity);
+            return static_cast<EventQueue<T>&>(*queue);
+        }
+
+        template <typename T>
+        EventQueue<T>& Get()
+        {
+            auto it = m_queues.find(std::type_index(typeid(T)));
+            SEECS_ASSERT(it != m_queues.end(), "Event type " << typeid(T).name() << " was not registered");
+            return static_cast<EventQueue<T>&>(*it->second);
+        }
+
+        template <typename T>
+        void Publish(const T& event)
+        {
+            Get<T>().Publish(event);
+        }
+
+        // Starts a new frame on every queue, call once per tick before the systems run
+        void BeginFrame()
+        {
+            for (auto& [type, queue] : m_queues) queue->BeginFrame();
+        }
+
+    private:
+        std::unordered_map<std::type_index, std::unique_ptr<IEventQueue>> m_queues;
+    };
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace seecs
+{
+    /**
+     * @brief Linear allocator for per-tick scratch memory
+     *
+     * Allocations bump a pointer through a block and are never freed one by
+     * one, Reset() releases everything at once at the start of the next tick.
+     * When a tick outgrows the current block another one is chained on, and the
+     * next Reset() replaces the chain with a single block big enough for the
+     * whole tick. After a growth tick, steady state is one block and no
+     * allocations.
+     *
+     * Memory is handed out uninitialized and destructors never run, so only
+     * trivially destructible types can be allocated. Not thread safe, allocate
+     * from the thread that owns the arena.
+     */
+    class FrameArena
+    {
+    public:
+        static constexpr size_t DEFAULT_ALIGN = 64; // Cache line, also fine for every SIMD load
+
+        explicit FrameArena(size_t initialBytes = 64 * 1024)
+        {
+            AddBlock(initialBytes);
+        }
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        /**
+         * @brief Releases every allocation made since the last reset
+         *
+         * Pointers and spans from earlier allocations must not be used afterwards.
+         */
+        void Reset()
+        {
+            if (m_blocks.size() > 1)
+            {
+                // Slack for the alignment padding each block boundary saved
+                size_t total = m_committed + m_offset + m_blocks.size()*DEFAULT_ALIGN;
+                m_blocks.clear();
+                AddBlock(total);
+            }
+
+            m_offset = 0;
+            m_committed = 0;
+        }
+
+        void* Allocate(size_t bytes, size_t align = DEFAULT_ALIGN)
+        {
+            size_t offset = (m_offset + align - 1) / align * align;
+            if (offset + bytes > m_blocks.back().size)
+            {
+                // Block sizes at least double so a growing tick chains few blocks
+                m_committed += m_offset;
+                AddBlock(std::max(bytes + align, m_blocks.back().size * 2));
+                offset = 0;
+            }
+
+            m_offset = offset + bytes;
+            m_highWater = std::max(m_highWater, m_committed + m_offset);
+            return m_blocks.back().data.get() + offset;
+        }
+
+        /**
+         * @brief Uninitialized array of count elements valid until the next Reset()
+         */
+        template <typename T>
+        std::span<T> AllocateArray(size_t count, size_t align = DEFAULT_ALIGN)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+            if (count == 0) return {};
+            return { static_cast<T*>(Allocate(count*sizeof(T), std::max(align, alignof(T)))), count };
+        }
+
+        size_t GetUsedBytes() const { return m_committed + m_offset; }
+        size_t GetCapacityBytes() const
+        {
+            size_t capacity = 0;
+            for (const Block& block : m_blocks) capacity += block.size;
+            return capacity;
+        }
+        size_t GetHighWaterBytes() const { return m_highWater; }
+
+    private:
+        struct Block
+        {
+            struct AlignedDelete
+            {
+                void operator()(std::byte* data) const { ::operator delete[](data, std::align_val_t(DEFAULT_ALIGN)); }
+            };
+
+            std::unique_ptr<std::byte[], AlignedDelete> data;
+            size_t size = 0;
+        };
+
+        std::vector<Block> m_blocks;
+        size_t m_offset = 0;    // Bytes used in the current (last) block
+        size_t m_committed = 0; // Bytes used in the blocks before it
+        size_t m_highWater = 0;
+
+        void AddBlock(size_t bytes)
+        {
+            bytes = std::max<size_t>(bytes, DEFAULT_ALIGN);
+            std::byte* data = static_cast<std::byte*>(::operator new[](bytes, std::align_val_t(DEFAULT_ALIGN)));
+            m_blocks.push_back({ std::unique_ptr<std::byte[], Block::AlignedDelete>(data), bytes });
+        }
+    };
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Work-stealing thread pool for data-parallel loops
+ *
+ * Every thread owns a job queue. A thread pops work from the back of its own
+ * queue and steals from the front of the others when it runs dry. Threads
+ * that wait on a ParallelFor() keep executing queued jobs in the meantime, so
+ * nested ParallelFor() calls from inside a job can't deadlock.
+ *
+ * Work is split into fixed-size ranges that only depend on the element count
+ * and grain, never on the number of threads. A loop body that only writes to
+ * its own elements gives the same result on any thread count.
+ */
+class JobSystem
+{
+public:
+    /**
+     * @param threadCount Total threads including the calling one,
+     *                    0 picks std::thread::hardware_concurrency()
+     */
+    explicit JobSystem(size_t threadCount = 0)
+    {
+#if defined(PLATFORM_WEB)
+        threadCount = 1; // No pthreads in the default Emscripten build
+#endif
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        // Queue 0 is shared by every thread that isn't a worker
+        for (size_t i = 0; i < threadCount; i++) m_queues.push_back(std::make_unique<Queue>());
+        for (size_t i = 1; i < threadCount; i++) m_threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_running = false;
+        }
+        m_wake.notify_all();
+
+        for (std::thread& thread : m_threads) thread.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Number of threads work is spread over, including the caller
+     */
+    size_t GetThreadCount() const { return m_threads.size() + 1; }
+
+    /**
+     * @brief Index of the calling thread, 0 for any thread outside this pool
+     *
+     * Workers of another pool count as outside threads too, so they share
+     * queue 0 with the main thread.
+     */
+    size_t GetThreadIndex() const { return (currentThread.pool == this)? currentThread.index : 0; }
+
+    /**
+     * @brief Run func(begin, end) over [0, count) split into ranges of grain elements
+     *
+     * Blocks until every range is done. The calling thread takes part in the work.
+     */
+    template <typename Func>
+    void ParallelFor(size_t count, size_t grain, Func&& func)
+    {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+
+        if (m_threads.empty() || count <= grain)
+        {
+            func((size_t)0, count);
+            return;
+        }
+
+        using FuncType = std::remove_reference_t<Func>;
+        auto run = [](void* context, size_t begin, size_t end) { (*static_cast<FuncType*>(context))(begin, end); };
+
+        size_t jobCount = (count + grain - 1)/grain;
+        std::atomic<size_t> pending(jobCount);
+
+        // Counted before they're pushed, so a thief never takes the count below zero
+        m_queuedJobs.fetch_add(jobCount, std::memory_order_release);
+
+        size_t self = GetThreadIndex();
+        Queue& queue = *m_queues[self];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            for (size_t begin = 0; begin < count; begin += grain)
+            {
+                queue.jobs.push_back({ run, (void*)&func, begin, std::min(begin + grain, count), &pending });
+            }
+        }
+
+        // Taking the lock before notifying means a worker can't miss the new
+        // jobs between checking the count and going to sleep
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+        }
+        m_wake.notify_all();
+
+        // Help out until our own jobs are done
+        while (pending.load(std::memory_order_acquire) > 0)
+        {
+            if (!TryRunJob(self)) std::this_thread::yield();
+        }
+    }
+
+private:
+    struct Job
+    {
+        void (*run)(void* context, size_t begin, size_t end);
+        void* context;
+        size_t begin;
+        size_t end;
+        std::atomic<size_t>* pending;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<Queue>> m_queues;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<size_t> m_queuedJobs = 0; // Jobs pushed and not yet taken, only sleeping needs m_wakeMutex
+    bool m_running = true;                 // Guarded by m_wakeMutex
+
+    struct ThreadSlot
+    {
+        const JobSystem* pool; // Pool the thread is a worker of, null outside any pool
+        size_t index;
+    };
+
+    inline static thread_local ThreadSlot currentThread = {};
+
+    bool PopJob(size_t queueIndex, bool steal, Job& job)
+    {
+        Queue& queue = *m_queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) return false;
+
+        if (steal)
+        {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+        else
+        {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+        }
+        return true;
+    }
+
+    bool TryRunJob(size_t self)
+    {
+        Job job = {};
+        bool found = PopJob(self, false, job);
+
+        for (size_t i = 1; !found && (i < m_queues.size()); i++)
+        {
+            found = PopJob((self + i)%m_queues.size(), true, job);
+        }
+
+        if (!found) return false;
+
+        m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        job.run(job.context, job.begin, job.end);
+        job.pending->fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    void WorkerLoop(size_t index)
+    {
+        currentThread = { this, index };
+
+        while (true)
+        {
+            if (TryRunJob(index)) continue;
+
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wake.wait(lock, [this] { return !m_running || (m_queuedJobs.load(std::memory_order_acquire) > 0); });
+            if (!m_running) return;
+        }
+    }
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Rate-limited log output written from a background thread
+ *
+ * Submit() only appends the line to a buffer, the writer thread formats the
+ * batch into a single write. Lines over the per-second budget are counted and
+ * reported as one summary line instead of being printed.
+ */
+class AsyncLogSink
+{
+public:
+    /**
+     * @param maxLinesPerSecond Lines accepted per second, extra ones are dropped
+     * @param out Stream the writer thread prints to
+     */
+    explicit AsyncLogSink(size_t maxLinesPerSecond = 20, std::ostream& out = std::cout)
+        : m_maxLinesPerSecond(maxLinesPerSecond), m_out(out)
+    {
+#if !defined(PLATFORM_WEB)
+        m_thread = std::thread(&AsyncLogSink::WriterLoop, this);
+#endif
+    }
+
+    ~AsyncLogSink()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_suppressed > 0) m_pending.push_back("(" + std::to_string(m_suppressed) + " log lines suppressed)");
+            m_running = false;
+        }
+        m_wake.notify_one();
+
+        if (m_thread.joinable()) m_thread.join();
+        else Flush();
+    }
+
+    AsyncLogSink(const AsyncLogSink&) = delete;
+    AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+    /**
+     * @brief Queue a line for output
+     * @return False if the line was dropped by the rate limit
+     */
+    bool Submit(std::string line)
+    {
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (now - m_windowStart >= std::chrono::seconds(1))
+            {
+                if (m_suppressed > 0) m_pending.push_back("(" + std::to_string(m_suppressed) + " log lines suppressed)");
+                m_windowStart = now;
+                m_windowLines = 0;
+                m_suppressed = 0;
+            }
+
+            if (m_windowLines >= m_maxLinesPerSecond)
+            {
+                m_suppressed++;
+                return false;
+            }
+
+            m_windowLines++;
+            m_pending.push_back(std::move(line));
+        }
+
+#if defined(PLATFORM_WEB)
+        Flush();
+#else
+        m_wake.notify_one();
+#endif
+        return true;
+    }
+
+private:
+    size_t m_maxLinesPerSecond;
+    std::ostream& m_out;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<std::string> m_pending;                 // Guarded by m_mutex
+    std::chrono::steady_clock::time_point m_windowStart; // Guarded by m_mutex
+    size_t m_windowLines = 0;                           // Guarded by m_mutex
+    size_t m_suppressed = 0;                            // Guarded by m_mutex
+    bool m_running = true;                              // Guarded by m_mutex
+    std::thread m_thread;
+
+    // Writes out everything pending, the lock is only held to swap the buffer
+    void Flush()
+    {
+        std::vector<std::string> batch;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            batch.swap(m_pending);
+        }
+        if (batch.empty()) return;
+
+        std::string text;
+        for (const std::string& line : batch)
+        {
+            text += line;
+            text += '\n';
+        }
+
+        m_out << text;
+        m_out.flush();
+    }
+
+    void WriterLoop()
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return !m_running || !m_pending.empty(); });
+                if (!m_running && m_pending.empty()) return;
+            }
+
+            Flush();
+        }
+    }
+};
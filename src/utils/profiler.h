@@ -0,0 +1,316 @@
+#pragma once
+
+#include "raylib.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "json.h"
+
+// Zones compile to nothing when 0, build with -DPROFILER_ENABLED=0 for release timings
+#ifndef PROFILER_ENABLED
+    #define PROFILER_ENABLED 1
+#endif
+
+namespace seecs
+{
+    /**
+     * @brief Frame profiler fed by scoped timers
+     *
+     * Zones are recorded into a ring buffer owned by the recording thread, so
+     * timing a zone never takes a lock. EndFrame() drains every thread's buffer
+     * on the main thread and folds the zones into per-name statistics over the
+     * last HISTORY_FRAMES frames. While a capture is running the raw events are
+     * also kept for WriteChromeTrace().
+     *
+     * EndFrame() must not run while other threads are recording, call it once
+     * per frame after the systems are done.
+     */
+    class Profiler
+    {
+    public:
+        static constexpr size_t RING_CAPACITY = 1 << 14;  // Events per thread between two EndFrame() calls
+        static constexpr size_t HISTORY_FRAMES = 120;
+        static constexpr size_t MAX_CAPTURE_EVENTS = 1 << 21;
+
+        using Clock = std::chrono::steady_clock;
+
+        struct Event
+        {
+            const char* name = nullptr; // Must outlive the profiler, string literals or long-lived strings
+            uint64_t startNs = 0;
+            uint64_t durationNs = 0;
+            uint32_t thread = 0;
+        };
+
+        // Rolling statistics of one zone, summed per frame if it ran several times.
+        // A zone running on several threads at once adds up their CPU time.
+        struct ZoneStats
+        {
+            std::string name;
+            double lastMs = 0.0;
+            double minMs = 0.0;
+            double averageMs = 0.0;
+            double p99Ms = 0.0;
+            size_t calls = 0; // Runs in the last frame it was seen in
+        };
+
+        static Profiler& Get()
+        {
+            static Profiler instance;
+            return instance;
+        }
+
+        static uint64_t Now()
+        {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - Get().m_epoch).count();
+        }
+
+        // Called by ProfileScope, appends to the calling thread's ring buffer
+        void Record(const char* name, uint64_t startNs, uint64_t endNs)
+        {
+            thread_local ThreadBuffer* buffer = nullptr;
+            if (!buffer) buffer = RegisterThread();
+
+            uint64_t written = buffer->written.load(std::memory_order_relaxed);
+            buffer->events[written & (RING_CAPACITY - 1)] = { name, startNs, endNs - startNs, buffer->thread };
+            buffer->written.store(written + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Drain every thread's events and update the zone statistics
+         */
+        void EndFrame()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_frameEvents.clear();
+
+            for (const std::unique_ptr<ThreadBuffer>& buffer : m_threads)
+            {
+                uint64_t written = buffer->written.load(std::memory_order_acquire);
+                if (written - buffer->read > RING_CAPACITY)
+                {
+                    m_droppedEvents += written - RING_CAPACITY - buffer->read;
+                    buffer->read = written - RING_CAPACITY;
+                }
+
+                for (; buffer->read < written; buffer->read++) m_frameEvents.push_back(buffer->events[buffer->read & (RING_CAPACITY - 1)]);
+            }
+
+            for (const Event& event : m_frameEvents)
+            {
+                Zone& zone = GetZone(event.name);
+                if (zone.lastFrame != m_frame)
+                {
+                    zone.lastFrame = m_frame;
+                    zone.frameNs = 0;
+                    zone.calls = 0;
+                }
+                zone.frameNs += event.durationNs;
+                zone.calls++;
+            }
+
+            for (Zone& zone : m_zones)
+            {
+                if (zone.lastFrame != m_frame) continue;
+                zone.history[zone.historyCount%HISTORY_FRAMES] = zone.frameNs/1.0e6;
+                zone.historyCount++;
+            }
+
+            if (m_capturing)
+            {
+                size_t room = MAX_CAPTURE_EVENTS - std::min(MAX_CAPTURE_EVENTS, m_captured.size());
+                size_t count = std::min(room, m_frameEvents.size());
+                m_captured.insert(m_captured.end(), m_frameEvents.begin(), m_frameEvents.begin() + count);
+                m_droppedEvents += m_frameEvents.size() - count;
+            }
+
+            m_frame++;
+        }
+
+        /**
+         * @brief Statistics of every zone seen so far, in the order they first ran
+         */
+        std::vector<ZoneStats> GetStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<ZoneStats> stats;
+            stats.reserve(m_zones.size());
+
+            std::vector<double> samples;
+            for (const Zone& zone : m_zones)
+            {
+                size_t count = std::min(zone.historyCount, HISTORY_FRAMES);
+                if (count == 0) continue;
+
+                samples.assign(zone.history.begin(), zone.history.begin() + count);
+                std::sort(samples.begin(), samples.end());
+
+                double sum = 0.0;
+                for (double sample : samples) sum += sample;
+
+                ZoneStats zoneStats;
+                zoneStats.name = zone.name;
+                zoneStats.lastMs = zone.history[(zone.historyCount - 1)%HISTORY_FRAMES];
+                zoneStats.minMs = samples.front();
+                zoneStats.averageMs = sum/count;
+                zoneStats.p99Ms = samples[std::min(count - 1, (size_t)(0.99*count))];
+                zoneStats.calls = zone.calls;
+                stats.push_back(zoneStats);
+            }
+
+            return stats;
+        }
+
+        // Keep raw events from the next EndFrame() on, up to MAX_CAPTURE_EVENTS
+        void StartCapture()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_captured.clear();
+            m_capturing = true;
+        }
+
+        /**
+         * @brief Write the captured events as Chrome trace-event JSON
+         *
+         * Open the file in chrome://tracing or https://ui.perfetto.dev.
+         * @return False if the file couldn't be written
+         */
+        bool WriteChromeTrace(const std::string& path) const
+        {
+            nlohmann::json events = nlohmann::json::array();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (const Event& event : m_captured)
+                {
+                    events.push_back({
+                        {"name", event.name},
+                        {"ph", "X"},
+                        {"ts", event.startNs/1000.0},
+                        {"dur", event.durationNs/1000.0},
+                        {"pid", 1},
+                        {"tid", event.thread}
+                    });
+                }
+            }
+
+            std::ofstream file(path);
+            if (!file) return false;
+            file << nlohmann::json{{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}}.dump() << std::endl;
+            return (bool)file;
+        }
+
+        // Events lost to a full ring buffer or capture since startup
+        uint64_t GetDroppedEvents() const { return m_droppedEvents; }
+
+        /**
+         * @brief Draw one line of min/avg/p99 per zone, top-left at (x, y)
+         */
+        void DrawOverlay(int x, int y, int fontSize = 10) const
+        {
+            const std::vector<ZoneStats> stats = GetStats();
+            char line[128];
+
+            DrawText("zone              last    min    avg    p99 (ms)", x, y, fontSize, DARKGRAY);
+            for (const ZoneStats& zone : stats)
+            {
+                y += fontSize + 2;
+                snprintf(line, sizeof(line), "%-16.16s %6.2f %6.2f %6.2f %6.2f", zone.name.c_str(), zone.lastMs, zone.minMs, zone.averageMs, zone.p99Ms);
+                DrawText(line, x, y, fontSize, DARKGRAY);
+            }
+        }
+
+    private:
+        struct ThreadBuffer
+        {
+            std::vector<Event> events = std::vector<Event>(RING_CAPACITY);
+            std::atomic<uint64_t> written = 0; // Only the owning thread writes
+            uint64_t read = 0;                 // Only EndFrame() touches it
+            uint32_t thread = 0;
+        };
+
+        struct Zone
+        {
+            std::string name;
+            std::vector<double> history = std::vector<double>(HISTORY_FRAMES); // Per-frame totals in ms, ring
+            size_t historyCount = 0;
+            uint64_t lastFrame = UINT64_MAX;
+            uint64_t frameNs = 0;
+            size_t calls = 0;
+        };
+
+        const Clock::time_point m_epoch = Clock::now();
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> m_threads; // Kept after threads exit, the thread_local pointers refer to them
+        std::vector<Zone> m_zones;
+        std::unordered_map<std::string, size_t> m_zoneIndex;
+        std::unordered_map<const char*, size_t> m_pointerIndex;
+        std::vector<Event> m_frameEvents;
+        std::vector<Event> m_captured;
+        bool m_capturing = false;
+        uint64_t m_frame = 0;
+        uint64_t m_droppedEvents = 0;
+
+        Profiler() = default;
+
+        ThreadBuffer* RegisterThread()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_threads.push_back(std::make_unique<ThreadBuffer>());
+            m_threads.back()->thread = (uint32_t)(m_threads.size() - 1);
+            return m_threads.back().get();
+        }
+
+        // Zones are keyed by name, the same literal can have several addresses.
+        // Pointers seen before skip building a string for the lookup.
+        Zone& GetZone(const char* name)
+        {
+            auto cached = m_pointerIndex.find(name);
+            if (cached != m_pointerIndex.end()) return m_zones[cached->second];
+
+            auto it = m_zoneIndex.find(name);
+            if (it == m_zoneIndex.end())
+            {
+                it = m_zoneIndex.emplace(name, m_zones.size()).first;
+                m_zones.push_back({ name });
+            }
+
+            m_pointerIndex.emplace(name, it->second);
+            return m_zones[it->second];
+        }
+    };
+
+    /**
+     * @brief Times its own lifetime as a profiler zone
+     */
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* name) : m_name(name), m_start(Profiler::Now()) {}
+        ~ProfileScope() { Profiler::Get().Record(m_name, m_start, Profiler::Now()); }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const char* m_name;
+        uint64_t m_start;
+    };
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+    #define PROFILE_ZONE(name) seecs::ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+    #define PROFILE_ZONE(name)
+#endif
@@ -3,18 +3,28 @@
 
 #include <array>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <limits>
 #include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <algorithm>
-#include <bitset>
 #include <memory>
 #include <type_traits>
-#include <typeindex>
 #include <functional>
-#include <typeinfo>
+#include <new>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <bit>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+#endif
 
 // Can replace these defines with custom macros elsewhere
 #ifndef SEECS_ASSERT
@@ -35,25 +45,355 @@
 	#define SEECS_MSG(msg) std::cout << "[SEECS]: " << msg << "\n";
 #endif
 
+// Component types one world can hold, a multiple of 64. Every entity's
+// mask takes MAX_COMPONENTS bits, so don't raise it further than needed.
+#ifndef SEECS_MAX_COMPONENTS
+	#define SEECS_MAX_COMPONENTS 128
+#endif
+
 namespace seecs {
 
-	// In ECS, entities are simply just indices which group data
-	using EntityID = uint64_t;
+	// In ECS, entities are simply just indices which group data.
+	//
+	// An EntityID is a generational handle: the low ENTITY_INDEX_BITS are the
+	// slot index, the high bits a version bumped every time the slot is freed.
+	// Handles to deleted entities keep their old version, so they stop being
+	// valid instead of aliasing whatever entity reuses the slot.
+	using EntityID = uint32_t;
+
+	constexpr EntityID ENTITY_INDEX_BITS = 24;
+	constexpr EntityID ENTITY_INDEX_MASK = (EntityID(1) << ENTITY_INDEX_BITS) - 1;
+	constexpr EntityID ENTITY_VERSION_MASK = std::numeric_limits<EntityID>::max() >> ENTITY_INDEX_BITS;
 
 
 	static constexpr EntityID NULL_ENTITY = std::numeric_limits<EntityID>::max();
 
 
 	// Max amount of entities alive at once.
-	// Set this to NULL_ENTITY if you want no limit.
+	// The last index is reserved so no handle can ever equal NULL_ENTITY.
 	// Once limit is hit, an assert will fire and
 	// the program will terminate.
-	constexpr size_t MAX_ENTITIES = NULL_ENTITY;
+	constexpr size_t MAX_ENTITIES = ENTITY_INDEX_MASK;
+
+
+	// Slot index of a handle, what sparse pages and per-entity arrays are indexed with
+	constexpr EntityID EntityIndex(EntityID id) {
+		return id & ENTITY_INDEX_MASK;
+	}
+
+	constexpr EntityID EntityVersion(EntityID id) {
+		return id >> ENTITY_INDEX_BITS;
+	}
+
+	constexpr EntityID MakeEntityID(EntityID index, EntityID version) {
+		return (index & ENTITY_INDEX_MASK) | ((version & ENTITY_VERSION_MASK) << ENTITY_INDEX_BITS);
+	}
 
 
-	// Should be a multiple of 32 (4 bytes), since
-	// bitset overallocates by 4 bytes each time.
-	constexpr size_t MAX_COMPONENTS = 64;
+	constexpr size_t MAX_COMPONENTS = SEECS_MAX_COMPONENTS;
+	static_assert(MAX_COMPONENTS > 0 && MAX_COMPONENTS % 64 == 0, "SEECS_MAX_COMPONENTS must be a multiple of 64");
+
+
+	// 64-bit FNV-1a, stable across builds and platforms
+	constexpr uint64_t HashString(std::string_view text) {
+		uint64_t hash = 14695981039346656037ull;
+		for (char c : text) {
+			hash ^= (uint8_t)c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	namespace detail {
+		template <typename T>
+		constexpr std::string_view TypeSignature() {
+#if defined(_MSC_VER) && !defined(__clang__)
+			return __FUNCSIG__;
+#else
+			return __PRETTY_FUNCTION__;
+#endif
+		}
+	}
+
+	/*
+	*  Name of T as the compiler spells it, known at compile time.
+	*  GCC and Clang: "seecs::components::Transform", MSVC drops the
+	*  "struct "/"class " prefix it adds so all three mostly agree.
+	*/
+	template <typename T>
+	constexpr std::string_view TypeName() {
+		std::string_view signature = detail::TypeSignature<T>();
+#if defined(_MSC_VER) && !defined(__clang__)
+		// "class std::basic_string_view<...> __cdecl seecs::detail::TypeSignature<struct Foo>(void)"
+		size_t begin = signature.find("TypeSignature<") + 14;
+		size_t end = signature.rfind(">(void)");
+		std::string_view name = signature.substr(begin, end - begin);
+		for (std::string_view prefix : { "struct ", "class ", "enum ", "union " })
+			if (name.substr(0, prefix.size()) == prefix)
+				return name.substr(prefix.size());
+		return name;
+#else
+		// GCC: "... TypeSignature() [with T = Foo; std::string_view = ...]", Clang: "... [T = Foo]"
+		size_t begin = signature.find("T = ") + 4;
+		size_t end = signature.find("; ", begin);
+		if (end == std::string_view::npos)
+			end = signature.rfind(']');
+		return signature.substr(begin, end - begin);
+#endif
+	}
+
+	// Stable 64-bit ID of a component type, a hash of its name. Unlike the
+	// order types are first used in, it's the same in every build.
+	using ComponentTypeID = uint64_t;
+
+	template <typename T>
+	inline constexpr ComponentTypeID TypeIdOf = HashString(TypeName<T>());
+
+
+	/*
+	*  Fixed-size bitset stored in 64-bit words, ComponentMask is one with
+	*  MAX_COMPONENTS bits. Has the parts of std::bitset the ECS uses, plus
+	*  Contains() and Intersects() to test masks without building a temporary.
+	*  Those compare 256 bits per AVX2 or 128 bits per SSE2 instruction.
+	*/
+	template <size_t Bits>
+	class BitMask {
+	public:
+		static constexpr size_t WORDS = (Bits + 63) / 64;
+
+		class reference {
+		public:
+			reference(uint64_t& word, uint64_t bit) : m_word(word), m_bit(bit) {}
+
+			reference& operator=(bool value) {
+				m_word = value ? (m_word | m_bit) : (m_word & ~m_bit);
+				return *this;
+			}
+			operator bool() const { return (m_word & m_bit) != 0; }
+
+		private:
+			uint64_t& m_word;
+			uint64_t m_bit;
+		};
+
+		bool operator[](size_t bit) const { return test(bit); }
+		reference operator[](size_t bit) { return { m_words[bit / 64], uint64_t(1) << (bit % 64) }; }
+
+		bool test(size_t bit) const { return (m_words[bit / 64] >> (bit % 64)) & 1; }
+		void set(size_t bit, bool value = true) { (*this)[bit] = value; }
+		void reset(size_t bit) { (*this)[bit] = false; }
+		static constexpr size_t size() { return Bits; }
+
+		bool any() const {
+			uint64_t bits = 0;
+			for (uint64_t word : m_words) bits |= word;
+			return bits != 0;
+		}
+		bool none() const { return !any(); }
+
+		size_t count() const {
+			size_t total = 0;
+			for (uint64_t word : m_words) total += std::popcount(word);
+			return total;
+		}
+
+		// True if every bit set in other is set here, (*this & other) == other
+		bool Contains(const BitMask& other) const {
+#if defined(__AVX2__)
+			if constexpr (WORDS % 4 == 0) {
+				for (size_t w = 0; w < WORDS; w += 4) {
+					__m256i mine = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_words[w]));
+					__m256i theirs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&other.m_words[w]));
+					if (!_mm256_testc_si256(mine, theirs)) return false;
+				}
+				return true;
+			}
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+			if constexpr (WORDS % 2 == 0) {
+				for (size_t w = 0; w < WORDS; w += 2) {
+					__m128i mine = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_words[w]));
+					__m128i theirs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&other.m_words[w]));
+					__m128i missing = _mm_andnot_si128(mine, theirs);
+					if (_mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) != 0xFFFF) return false;
+				}
+				return true;
+			}
+#endif
+			uint64_t missing = 0;
+			for (size_t w = 0; w < WORDS; w++) missing |= other.m_words[w] & ~m_words[w];
+			return missing == 0;
+		}
+
+		// True if any bit is set in both, (*this & other).any()
+		bool Intersects(const BitMask& other) const {
+#if defined(__AVX2__)
+			if constexpr (WORDS % 4 == 0) {
+				for (size_t w = 0; w < WORDS; w += 4) {
+					__m256i mine = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_words[w]));
+					__m256i theirs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&other.m_words[w]));
+					if (!_mm256_testz_si256(mine, theirs)) return true;
+				}
+				return false;
+			}
+#endif
+			uint64_t shared = 0;
+			for (size_t w = 0; w < WORDS; w++) shared |= m_words[w] & other.m_words[w];
+			return shared != 0;
+		}
+
+		/*
+		*  True if every bit of include and no bit of exclude is set here,
+		*  Contains(include) && !Intersects(exclude) without the branches.
+		*  Views filter entities with it, their matches are hard to predict.
+		*/
+		bool Matches(const BitMask& include, const BitMask& exclude) const {
+#if defined(__AVX2__)
+			if constexpr (WORDS % 4 == 0) {
+				__m256i wrong = _mm256_setzero_si256();
+				for (size_t w = 0; w < WORDS; w += 4) {
+					__m256i mine = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_words[w]));
+					__m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&include.m_words[w]));
+					__m256i out = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&exclude.m_words[w]));
+					wrong = _mm256_or_si256(wrong, _mm256_or_si256(_mm256_andnot_si256(mine, in), _mm256_and_si256(mine, out)));
+				}
+				return _mm256_testz_si256(wrong, wrong);
+			}
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+			if constexpr (WORDS % 2 == 0) {
+				__m128i wrong = _mm_setzero_si128();
+				for (size_t w = 0; w < WORDS; w += 2) {
+					__m128i mine = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_words[w]));
+					__m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&include.m_words[w]));
+					__m128i out = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&exclude.m_words[w]));
+					wrong = _mm_or_si128(wrong, _mm_or_si128(_mm_andnot_si128(mine, in), _mm_and_si128(mine, out)));
+				}
+				return _mm_movemask_epi8(_mm_cmpeq_epi8(wrong, _mm_setzero_si128())) == 0xFFFF;
+			}
+#endif
+			uint64_t wrong = 0;
+			for (size_t w = 0; w < WORDS; w++) wrong |= (include.m_words[w] & ~m_words[w]) | (exclude.m_words[w] & m_words[w]);
+			return wrong == 0;
+		}
+
+		// Calls func(bit) for every set bit, in increasing order
+		template <typename Func>
+		void ForEachSetBit(Func&& func) const {
+			for (size_t w = 0; w < WORDS; w++)
+				for (uint64_t word = m_words[w]; word != 0; word &= word - 1)
+					func(w * 64 + std::countr_zero(word));
+		}
+
+		BitMask& operator&=(const BitMask& other) {
+			for (size_t w = 0; w < WORDS; w++) m_words[w] &= other.m_words[w];
+			return *this;
+		}
+		BitMask& operator|=(const BitMask& other) {
+			for (size_t w = 0; w < WORDS; w++) m_words[w] |= other.m_words[w];
+			return *this;
+		}
+		friend BitMask operator&(BitMask a, const BitMask& b) { return a &= b; }
+		friend BitMask operator|(BitMask a, const BitMask& b) { return a |= b; }
+		friend bool operator==(const BitMask& a, const BitMask& b) { return a.m_words == b.m_words; }
+
+		struct Hasher {
+			size_t operator()(const BitMask& mask) const { return mask.Hash(); }
+		};
+
+		size_t Hash() const {
+			uint64_t hash = 14695981039346656037ull;
+			for (uint64_t word : m_words) hash = (hash ^ word) * 1099511628211ull;
+			return (size_t)hash;
+		}
+
+		// Highest bit first, like std::bitset
+		friend std::ostream& operator<<(std::ostream& out, const BitMask& mask) {
+			for (size_t bit = Bits; bit-- > 0;) out << (mask.test(bit) ? '1' : '0');
+			return out;
+		}
+
+	private:
+		std::array<uint64_t, WORDS> m_words{};
+	};
+
+
+	/*
+	*  Maps component type IDs to the slots one world numbers its components
+	*  with, in the order they're first used there. Slots index the world's
+	*  pools and mask bits. Open addressing in a fixed table at most half
+	*  full, so a lookup is usually a single probe.
+	*/
+	class ComponentRegistry {
+	public:
+		static constexpr size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+
+		size_t Find(ComponentTypeID id) const {
+			for (size_t i = id & TABLE_MASK;; i = (i + 1) & TABLE_MASK) {
+				const Entry& entry = m_table[i];
+				if (entry.id == id && entry.slot != NOT_FOUND) return entry.slot;
+				if (entry.slot == NOT_FOUND) return NOT_FOUND;
+			}
+		}
+
+		// Gives a type that isn't registered yet the next slot
+		size_t Insert(ComponentTypeID id, std::string_view name) {
+			SEECS_ASSERT(m_names.size() < MAX_COMPONENTS,
+				"Exceeded max number of registered components (" << MAX_COMPONENTS << "), raise SEECS_MAX_COMPONENTS");
+
+			size_t i = id & TABLE_MASK;
+			while (m_table[i].slot != NOT_FOUND)
+				i = (i + 1) & TABLE_MASK;
+
+			m_table[i] = { id, m_names.size() };
+			m_ids.push_back(id);
+			m_names.emplace_back(name);
+			m_nameData.push_back(name.data());
+			return m_table[i].slot;
+		}
+
+		// Asserts slot was registered under name, two names can hash to the
+		// same ID. Names from TypeName() are compile-time strings, so the same
+		// type usually passes on the pointer alone.
+		void CheckName(size_t slot, std::string_view name) const {
+			if (name.data() != m_nameData[slot]) [[unlikely]] {
+				SEECS_ASSERT(m_names[slot] == name,
+					"Component '" << name << "' has the same type ID as '" << m_names[slot] << "'");
+			}
+		}
+
+		size_t Size() const { return m_names.size(); }
+		ComponentTypeID GetId(size_t slot) const { return m_ids[slot]; }
+		const std::string& GetName(size_t slot) const { return m_names[slot]; }
+
+	private:
+		static constexpr size_t TABLE_SIZE = std::bit_ceil(MAX_COMPONENTS * 2);
+		static constexpr size_t TABLE_MASK = TABLE_SIZE - 1;
+
+		struct Entry {
+			ComponentTypeID id = 0;
+			size_t slot = NOT_FOUND;
+		};
+
+		std::array<Entry, TABLE_SIZE> m_table{};
+		std::vector<ComponentTypeID> m_ids;
+		std::vector<std::string> m_names;
+		std::vector<const char*> m_nameData; // Only compared, Insert()'s string may be gone
+	};
+
+
+	// Bytes held by one sparse set, see ECS::GetMemoryReport()
+	struct PoolMemoryUsage {
+		size_t count = 0;		// Elements stored
+		size_t capacity = 0;	// Elements the dense arrays can hold without growing
+		size_t denseBytes = 0;	// Dense component and entity arrays, by capacity
+		size_t sparseBytes = 0;	// Allocated sparse pages plus the page table
+		size_t sparsePages = 0;	// Pages actually allocated
+
+		size_t TotalBytes() const {
+			return denseBytes + sparseBytes;
+		}
+	};
 
 
 	// Base class allows runtime polymorphism
@@ -65,6 +405,15 @@ namespace seecs {
 		virtual size_t Size() = 0;
 		virtual bool ContainsEntity(EntityID id) = 0;
 		virtual std::vector<EntityID> GetEntityList() = 0;
+		virtual const std::vector<EntityID>& Entities() const = 0;
+		virtual size_t DenseIndexOf(EntityID id) = 0;
+		virtual void SwapDense(size_t a, size_t b) = 0;
+		virtual size_t RemoveMarked(const std::vector<bool>& marked) = 0;
+		virtual void Reserve(size_t count) = 0;
+		virtual void ShrinkToFit() = 0;
+		virtual PoolMemoryUsage GetMemoryUsage() const = 0;
+		virtual void TrackChanges(uint32_t tick) = 0;
+		virtual void SetTick(uint32_t tick) = 0;
 	};
 
 
@@ -82,12 +431,157 @@ namespace seecs {
 		using get = std::tuple_element_t<Index, type_tuple>;
 
 		static constexpr size_t size = sizeof...(Types);
+
+		// Position of T in the list, size if it isn't in it
+		template <typename T>
+		static constexpr size_t index_of = [] {
+			size_t index = 0;
+			((std::is_same_v<T, Types> ? false : (index++, true)) && ...);
+			return index;
+		}();
+	};
+
+
+
+	/*
+	*  Vector-like container that stores its elements in fixed-size pages.
+	*
+	*  Growing allocates a new page and never moves existing elements, so
+	*  pointers stay valid while the container grows and spawning a wave of
+	*  entities doesn't copy the whole array. Pages hold about PAGE_BYTES
+	*  worth of elements, rounded down to a power of two so indexing is a
+	*  shift and a mask. Elements are only contiguous within a page.
+	*
+	*  That lookup isn't free: views over paged pools iterate noticeably
+	*  slower than over std::vector, so only use it for pools that grow
+	*  in large bursts or whose element addresses must stay put.
+	*/
+	template <typename T, size_t PAGE_BYTES = 16 * 1024>
+	class PagedVector {
+	private:
+
+		static constexpr size_t PageSize() {
+			size_t size = 1;
+			while (size * 2 * sizeof(T) <= PAGE_BYTES)
+				size *= 2;
+			return size;
+		}
+
+		static constexpr size_t PAGE_SIZE = PageSize();
+
+		std::vector<T*> m_pages;
+		size_t m_size = 0;
+
+		void AddPage() {
+			void* page = ::operator new(PAGE_SIZE * sizeof(T), std::align_val_t(alignof(T)));
+			m_pages.push_back(static_cast<T*>(page));
+		}
+
+		void FreePage(T* page) {
+			::operator delete(page, std::align_val_t(alignof(T)));
+		}
+
+	public:
+
+		PagedVector() = default;
+
+		PagedVector(const PagedVector&) = delete;
+		PagedVector& operator=(const PagedVector&) = delete;
+
+		~PagedVector() {
+			clear();
+			for (T* page : m_pages)
+				FreePage(page);
+		}
+
+		T& operator[](size_t index) {
+			return m_pages[index / PAGE_SIZE][index % PAGE_SIZE];
+		}
+
+		const T& operator[](size_t index) const {
+			return m_pages[index / PAGE_SIZE][index % PAGE_SIZE];
+		}
+
+		T& back() {
+			return (*this)[m_size - 1];
+		}
+
+		void push_back(T obj) {
+			if (m_size == capacity())
+				AddPage();
+			new (&(*this)[m_size]) T(std::move(obj));
+			m_size++;
+		}
+
+		void pop_back() {
+			back().~T();
+			m_size--;
+		}
+
+		// Destroys every element, pages are kept for reuse
+		void clear() {
+			while (m_size > 0)
+				pop_back();
+		}
+
+		void reserve(size_t count) {
+			while (capacity() < count)
+				AddPage();
+		}
+
+		// Frees the pages past the last element
+		void shrink_to_fit() {
+			size_t needed = (m_size + PAGE_SIZE - 1) / PAGE_SIZE;
+			while (m_pages.size() > needed) {
+				FreePage(m_pages.back());
+				m_pages.pop_back();
+			}
+			m_pages.shrink_to_fit();
+		}
+
+		size_t size() const {
+			return m_size;
+		}
+
+		bool empty() const {
+			return m_size == 0;
+		}
+
+		size_t capacity() const {
+			return m_pages.size() * PAGE_SIZE;
+		}
 	};
 
 
+	/*
+	*  Selects the container behind a component pool's dense array, which is
+	*  also how a pool gets a custom allocator. Specialize it per component type:
+	*
+	*    // Elements never move when the pool grows
+	*    template <> struct seecs::PoolStorage<Transform> { using type = seecs::PagedVector<Transform>; };
+	*
+	*    // Any vector-like container with the same interface works
+	*    template <> struct seecs::PoolStorage<Bullet> { using type = std::vector<Bullet, BulletAllocator<Bullet>>; };
+	*
+	*  The specialization must be visible wherever the component is used.
+	*/
+	template <typename T>
+	struct PoolStorage {
+		using type = std::vector<T>;
+	};
+
 
 	/*
 	*  A templated sparse set implementation, mapping EntityID -> T
+	*
+	*  Sparse pages are indexed by the handle's slot index only. Sets don't check
+	*  versions, the ECS validates handles before touching any of its sets.
+	*
+	*  Pages are held by pointer and only allocated once an entity in their
+	*  range is added, so a high ID in a rarely used pool costs one page rather
+	*  than every page below it. Dense indices are 32-bit, a page is 8 KiB.
+	*
+	*  The dense component array is a PoolStorage<T>::type.
 	* 
 	*  - Get(EntityID): returns T or NULL if EntityID is not in sparse set
 	*  - Set(EntityID, T&&): Adds/Overwrites into the dense list for the specified entity
@@ -98,15 +592,28 @@ namespace seecs {
 	private:
 
 		static constexpr size_t SPARSE_MAX_SIZE = 2048;
-		static constexpr size_t tombstone = std::numeric_limits<size_t>::max();
 
-		using Sparse = std::array<size_t, SPARSE_MAX_SIZE>;
+		// Dense indices fit in 32 bits since MAX_ENTITIES does
+		using DenseIndex = uint32_t;
+		static constexpr DenseIndex tombstone = std::numeric_limits<DenseIndex>::max();
+
+		using Sparse = std::array<DenseIndex, SPARSE_MAX_SIZE>;
+
+		// Null for pages no entity has touched yet
+		std::vector<std::unique_ptr<Sparse>> m_sparsePages;
 
-		std::vector<Sparse> m_sparsePages;
+		using Dense = typename PoolStorage<T>::type;
 
-		std::vector<T> m_dense;
+		Dense m_dense;
 		std::vector<EntityID> m_denseToEntity; // 1:1 vector where dense index == Entity Index
 
+		// Change tracking, see ECS::TrackChanges(). While tracking, both tick
+		// vectors are 1:1 with m_dense, otherwise they stay empty.
+		bool m_tracking = false;
+		uint32_t m_tick = 0;
+		std::vector<uint32_t> m_addedTicks;
+		std::vector<uint32_t> m_changedTicks;
+
 		/*
 		* Inserts a given dense index into the sparse vector, associating
 		* an Entity ID with the index in the dense vector.
@@ -114,16 +621,22 @@ namespace seecs {
 		* This doesnt actually insert anything into the dense
 		* vector, it simply defines a mapping from ID -> index
 		*/
-		inline void SetDenseIndex(EntityID id, size_t index) {
-			size_t page = id / SPARSE_MAX_SIZE;
-			size_t sparseIndex = id % SPARSE_MAX_SIZE; // Index local to a page
+		inline void SetDenseIndex(EntityID id, DenseIndex index) {
+			size_t page = EntityIndex(id) / SPARSE_MAX_SIZE;
+			size_t sparseIndex = EntityIndex(id) % SPARSE_MAX_SIZE; // Index local to a page
 
-			if (page >= m_sparsePages.size()) {
+			if (page >= m_sparsePages.size())
 				m_sparsePages.resize(page + 1);
-				m_sparsePages[page].fill(tombstone);
+
+			if (!m_sparsePages[page]) {
+				// Clearing a slot never needs a page
+				if (index == tombstone) return;
+
+				m_sparsePages[page] = std::make_unique<Sparse>();
+				m_sparsePages[page]->fill(tombstone);
 			}
 
-			Sparse& sparse = m_sparsePages[page];
+			Sparse& sparse = *m_sparsePages[page];
 
 			sparse[sparseIndex] = index;
 		}
@@ -132,52 +645,87 @@ namespace seecs {
 		* Returns the dense index for a given entity ID,
 		* or a tombstone (null) value if non-existent
 		*/
-		inline size_t GetDenseIndex(EntityID id) {
-			size_t page = id / SPARSE_MAX_SIZE;
-			size_t sparseIndex = id % SPARSE_MAX_SIZE;
+		inline DenseIndex GetDenseIndex(EntityID id) const {
+			size_t page = EntityIndex(id) / SPARSE_MAX_SIZE;
+			size_t sparseIndex = EntityIndex(id) % SPARSE_MAX_SIZE;
 
-			if (page < m_sparsePages.size()) {
-				Sparse& sparse = m_sparsePages[page];
-				return sparse[sparseIndex];
-			}
+			if (page < m_sparsePages.size() && m_sparsePages[page])
+				return (*m_sparsePages[page])[sparseIndex];
 
 			return tombstone;
 		}
 
+
 	public:
 
-		SparseSet() {
-			// Avoids initial copies/allocation, feel free to alter size
-			m_dense.reserve(1000);
-			m_denseToEntity.reserve(1000);
+		// Reserves room for initialReserve elements up front,
+		// see ECS::Reserve() for setting it per component type
+		explicit SparseSet(size_t initialReserve = 0) {
+			Reserve(initialReserve);
 		}
 
 		T* Set(EntityID id, T obj) {
 			// Overwrite existing elements
-			size_t index = GetDenseIndex(id);
+			DenseIndex index = GetDenseIndex(id);
 			if (index != tombstone) {
-				m_dense[index] = obj;
+				m_dense[index] = std::move(obj);
 				m_denseToEntity[index] = id;
+				MarkChangedAt(index);
 
 				return &m_dense[index];
 			}
 
 			// New index will be the back of the dense list
-			SetDenseIndex(id, m_dense.size());
+			SetDenseIndex(id, (DenseIndex)m_dense.size());
 
-			m_dense.push_back(obj);
+			m_dense.push_back(std::move(obj));
 			m_denseToEntity.push_back(id);
+			if (m_tracking) {
+				m_addedTicks.push_back(m_tick);
+				m_changedTicks.push_back(m_tick);
+			}
 
 			return &m_dense.back();
 		}
 
 		T* Get(EntityID id) {
-			size_t index = GetDenseIndex(id);
+			DenseIndex index = GetDenseIndex(id);
 			return (index != tombstone) ? &m_dense[index] : nullptr;
 		}
 
+		/*
+		*  Appends entities that aren't in the set yet, each with a copy of value.
+		*  The dense arrays grow at most once, see ECS::CreateEntities().
+		*/
+		void Append(std::span<const EntityID> entities, const T& value) {
+			const size_t first = m_dense.size();
+			const size_t total = first + entities.size();
+			if (total > m_dense.capacity())
+				Reserve(std::max(total, m_dense.capacity() * 2));
+
+			if constexpr (requires (Dense& dense) { dense.resize(total, value); })
+				m_dense.resize(total, value);
+			else {
+				for (size_t i = 0; i < entities.size(); i++)
+					m_dense.push_back(value);
+			}
+			m_denseToEntity.insert(m_denseToEntity.end(), entities.begin(), entities.end());
+			if (m_tracking) {
+				m_addedTicks.resize(total, m_tick);
+				m_changedTicks.resize(total, m_tick);
+			}
+
+			for (size_t i = 0; i < entities.size(); i++)
+				SetDenseIndex(entities[i], (DenseIndex)(first + i));
+		}
+
+		// Direct access by dense index, no bounds or tombstone checks
+		T* GetAt(size_t denseIndex) {
+			return &m_dense[denseIndex];
+		}
+
 		T& GetRef(EntityID id) {
-			size_t index = GetDenseIndex(id);
+			DenseIndex index = GetDenseIndex(id);
 			if (index == tombstone)
 				SEECS_ASSERT(false, "GetRef called on invalid entity with ID " << id);
 			return m_dense[index];
@@ -185,7 +733,7 @@ namespace seecs {
 
 		void Delete(EntityID id) override {
 
-			size_t deletedIndex = GetDenseIndex(id);
+			DenseIndex deletedIndex = GetDenseIndex(id);
 
 			if (m_dense.empty() || deletedIndex == tombstone) return;
 
@@ -197,24 +745,247 @@ namespace seecs {
 
 			m_dense.pop_back();
 			m_denseToEntity.pop_back();
+
+			if (m_tracking) {
+				m_addedTicks[deletedIndex] = m_addedTicks.back();
+				m_changedTicks[deletedIndex] = m_changedTicks.back();
+				m_addedTicks.pop_back();
+				m_changedTicks.pop_back();
+			}
 		}
 
 		size_t Size() override {
 			return m_dense.size();
 		}
 
+		/*
+		*  Removes every entity whose slot index is set in marked, in one pass
+		*  that keeps the order of the rest, see ECS::DestroyEntities().
+		*  Returns the number of entities removed.
+		*/
+		size_t RemoveMarked(const std::vector<bool>& marked) override {
+			size_t kept = 0;
+			for (size_t i = 0; i < m_dense.size(); i++) {
+				EntityID id = m_denseToEntity[i];
+				if (EntityIndex(id) < marked.size() && marked[EntityIndex(id)]) {
+					SetDenseIndex(id, tombstone);
+					continue;
+				}
+
+				if (kept != i) {
+					m_dense[kept] = std::move(m_dense[i]);
+					m_denseToEntity[kept] = id;
+					SetDenseIndex(id, (DenseIndex)kept);
+					if (m_tracking) {
+						m_addedTicks[kept] = m_addedTicks[i];
+						m_changedTicks[kept] = m_changedTicks[i];
+					}
+				}
+				kept++;
+			}
+
+			const size_t removed = m_dense.size() - kept;
+			if constexpr (requires (Dense& dense) { dense.erase(dense.begin(), dense.end()); })
+				m_dense.erase(m_dense.begin() + kept, m_dense.end());
+			else {
+				while (m_dense.size() > kept)
+					m_dense.pop_back();
+			}
+			m_denseToEntity.resize(kept);
+			if (m_tracking) {
+				m_addedTicks.resize(kept);
+				m_changedTicks.resize(kept);
+			}
+			return removed;
+		}
+
+		size_t DenseIndexOf(EntityID id) override {
+			return GetDenseIndex(id);
+		}
+
+		/*
+		*  Swaps two elements of the dense list and fixes up the sparse mapping,
+		*  used by owning groups to keep their members packed at the front.
+		*/
+		void SwapDense(size_t a, size_t b) override {
+			if (a == b) return;
+
+			std::swap(m_dense[a], m_dense[b]);
+			std::swap(m_denseToEntity[a], m_denseToEntity[b]);
+			if (m_tracking) {
+				std::swap(m_addedTicks[a], m_addedTicks[b]);
+				std::swap(m_changedTicks[a], m_changedTicks[b]);
+			}
+
+			SetDenseIndex(m_denseToEntity[a], (DenseIndex)a);
+			SetDenseIndex(m_denseToEntity[b], (DenseIndex)b);
+		}
+
+		void Reserve(size_t count) override {
+			m_dense.reserve(count);
+			m_denseToEntity.reserve(count);
+			if (m_tracking) {
+				m_addedTicks.reserve(count);
+				m_changedTicks.reserve(count);
+			}
+		}
+
+		/*
+		*  Releases spare dense capacity and every sparse page no
+		*  longer referenced by an entity.
+		*/
+		void ShrinkToFit() override {
+			m_dense.shrink_to_fit();
+			m_denseToEntity.shrink_to_fit();
+			m_addedTicks.shrink_to_fit();
+			m_changedTicks.shrink_to_fit();
+
+			for (std::unique_ptr<Sparse>& page : m_sparsePages) {
+				if (!page) continue;
+				bool used = std::any_of(page->begin(), page->end(),
+					[](DenseIndex index) { return index != tombstone; });
+				if (!used) page.reset();
+			}
+
+			while (!m_sparsePages.empty() && !m_sparsePages.back())
+				m_sparsePages.pop_back();
+			m_sparsePages.shrink_to_fit();
+		}
+
+		/*
+		*  Memory held by this set. Heap memory owned by the
+		*  components themselves (e.g. string contents) isn't counted.
+		*/
+		PoolMemoryUsage GetMemoryUsage() const override {
+			PoolMemoryUsage usage;
+			usage.count = m_dense.size();
+			usage.capacity = m_dense.capacity();
+			usage.denseBytes = m_dense.capacity() * sizeof(T) + m_denseToEntity.capacity() * sizeof(EntityID)
+				+ (m_addedTicks.capacity() + m_changedTicks.capacity()) * sizeof(uint32_t);
+			usage.sparseBytes = m_sparsePages.capacity() * sizeof(std::unique_ptr<Sparse>);
+
+			for (const std::unique_ptr<Sparse>& page : m_sparsePages)
+				if (page) usage.sparsePages++;
+			usage.sparseBytes += usage.sparsePages * sizeof(Sparse);
+
+			return usage;
+		}
+
 		std::vector<EntityID> GetEntityList() override {
 			return m_denseToEntity;
 		}
 
+		/*
+		*  Replaces the contents with count elements in one pass, used to load
+		*  snapshots. entities points to count unique EntityIDs. If components
+		*  isn't null it holds count raw T's, copied with one memcpy into
+		*  contiguous storage, otherwise components are default constructed.
+		*  Neither pointer needs to be aligned.
+		*/
+		void Assign(const void* entities, size_t count, const void* components = nullptr) {
+			Clear();
+
+			m_denseToEntity.resize(count);
+			if (count > 0)
+				std::memcpy(m_denseToEntity.data(), entities, count * sizeof(EntityID));
+
+			if constexpr (requires (Dense& dense) { dense.resize(count); })
+				m_dense.resize(count);
+			else {
+				m_dense.reserve(count);
+				for (size_t i = 0; i < count; i++)
+					m_dense.push_back(T{});
+			}
+
+			if (components) {
+				if constexpr (std::is_trivially_copyable_v<T>) {
+					if constexpr (requires (Dense& dense) { dense.data(); }) {
+						if (count > 0)
+							std::memcpy(m_dense.data(), components, count * sizeof(T));
+					}
+					else {
+						for (size_t i = 0; i < count; i++)
+							std::memcpy(&m_dense[i], static_cast<const std::byte*>(components) + i * sizeof(T), sizeof(T));
+					}
+				}
+				else {
+					SEECS_ASSERT(false, "Raw component data given for a type that isn't trivially copyable");
+				}
+			}
+
+			if (m_tracking) {
+				m_addedTicks.assign(count, m_tick);
+				m_changedTicks.assign(count, m_tick);
+			}
+
+			for (size_t i = 0; i < count; i++)
+				SetDenseIndex(m_denseToEntity[i], (DenseIndex)i);
+		}
+
+		/*
+		*  Starts recording, per element, the tick it was added at and the
+		*  tick it was last changed at. Elements already in the set count as
+		*  added and changed at tick.
+		*/
+		void TrackChanges(uint32_t tick) override {
+			m_tracking = true;
+			m_tick = tick;
+			m_addedTicks.assign(m_dense.size(), tick);
+			m_changedTicks.assign(m_dense.size(), tick);
+		}
+
+		// Tick stamped on elements added or changed from now on
+		void SetTick(uint32_t tick) override {
+			m_tick = tick;
+		}
+
+		bool IsTracked() const {
+			return m_tracking;
+		}
+
+		// Stamps the element as changed at the current tick, no-op when not tracking
+		void MarkChangedAt(size_t denseIndex) {
+			if (m_tracking)
+				m_changedTicks[denseIndex] = m_tick;
+		}
+
+		void MarkChanged(EntityID id) {
+			DenseIndex index = GetDenseIndex(id);
+			if (index != tombstone)
+				MarkChangedAt(index);
+		}
+
+		// Ticks 1:1 with Data(), empty when not tracking
+		const std::vector<uint32_t>& AddedTicks() const {
+			return m_addedTicks;
+		}
+
+		const std::vector<uint32_t>& ChangedTicks() const {
+			return m_changedTicks;
+		}
+
 		bool ContainsEntity(EntityID id) override {
+			return Contains(id);
+		}
+
+		// Non-virtual version of ContainsEntity for typed access
+		bool Contains(EntityID id) {
 			return GetDenseIndex(id) != tombstone;
 		}
 
+		// Read-only dense entity list, 1:1 with Data(). Unlike GetEntityList()
+		// this doesn't copy, so the pool must not be structurally modified
+		// while the reference is in use.
+		const std::vector<EntityID>& Entities() const override {
+			return m_denseToEntity;
+		}
+
 		void Clear() override {
 			m_dense.clear();
 			m_sparsePages.clear();
 			m_denseToEntity.clear();
+			m_addedTicks.clear();
+			m_changedTicks.clear();
 		}
 
 		bool IsEmpty() const {
@@ -222,15 +993,15 @@ namespace seecs {
 		}
 
 		// Read-only dense list
-		const std::vector<T>& Data() const {
+		const Dense& Data() const {
 			return m_dense;
 		}
 
 		void PrintDense() {
 			std::stringstream ss;
 			std::string delim = "";
-			for (const T& e : m_dense) {
-				ss << delim << e;
+			for (size_t i = 0; i < m_dense.size(); i++) {
+				ss << delim << m_dense[i];
 				if (delim.empty())
 					delim = ", ";
 			}
@@ -239,23 +1010,244 @@ namespace seecs {
 
 	};
 
+	// Each bit in the mask represents a component slot of the world,
+	// '1' == active, '0' == inactive.
+	using ComponentMask = BitMask<MAX_COMPONENTS>;
+
+
+	// Selects how the ECS stores component data, see ECS::ECS()
+	enum class StorageMode {
+		SparseSet,	// One sparse set per component type (default)
+		Archetype	// Entities grouped by component mask into SoA chunks
+	};
+
+
+	/*
+	*  Type-erased description of a component, lets archetypes move
+	*  and destroy components without knowing their type.
+	*/
+	struct ComponentInfo {
+		size_t size = 0;
+		size_t align = 0;
+		void (*moveConstruct)(void* dst, void* src) = nullptr;
+		void (*destroy)(void* ptr) = nullptr;
+
+		template <typename T>
+		static ComponentInfo Make() {
+			return {
+				sizeof(T), alignof(T),
+				[](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); },
+				[](void* ptr) { static_cast<T*>(ptr)->~T(); }
+			};
+		}
+	};
+
+
+	/*
+	*  Storage for all entities sharing the exact same component mask.
+	*
+	*  Entities live in fixed-size chunks: each chunk starts with an entity ID
+	*  column followed by one tightly packed array per component (SoA).
+	*  Rows stay dense, removing a row moves the archetype's last row into the hole.
+	*
+	*  - Allocate(EntityID): appends a row, component memory is left uninitialized
+	*  - RemoveRow(row): destroys the row's components and fills the hole
+	*  - At(component, row): address of a component in a given row
+	*/
+	class Archetype {
+	public:
+
+		static constexpr size_t CHUNK_SIZE = 16 * 1024;
+		static constexpr size_t CHUNK_ALIGN = 64;
+		static constexpr size_t NO_COLUMN = std::numeric_limits<size_t>::max();
+
+		struct Chunk {
+			std::byte* data = nullptr;
+			size_t count = 0;
+
+			EntityID* Entities() const {
+				return reinterpret_cast<EntityID*>(data);
+			}
+		};
+
+	private:
+
+		struct Column {
+			size_t component;
+			size_t offset; // Byte offset of the column inside a chunk
+			ComponentInfo info;
+		};
+
+		ComponentMask m_mask;
+		std::vector<Column> m_columns;
+		std::array<size_t, MAX_COMPONENTS> m_columnOf; // Component index -> column, or NO_COLUMN
+
+		// Cached neighbours in the archetype graph, indexed by the component
+		// being added/removed, so migrations skip the mask lookup
+		std::array<Archetype*, MAX_COMPONENTS> m_addEdges{};
+		std::array<Archetype*, MAX_COMPONENTS> m_removeEdges{};
+
+		std::vector<Chunk> m_chunks;
+		size_t m_capacity = 0;	// Rows per chunk
+		size_t m_chunkBytes = 0;
+		size_t m_size = 0;
+
+		static size_t AlignUp(size_t value, size_t align) {
+			return (value + align - 1) / align * align;
+		}
+
+		// Lays the columns out for a given row capacity, returns the bytes needed
+		size_t Layout(size_t capacity) {
+			size_t offset = sizeof(EntityID) * capacity;
+			for (Column& column : m_columns) {
+				offset = AlignUp(offset, column.info.align);
+				column.offset = offset;
+				offset += column.info.size * capacity;
+			}
+			return offset;
+		}
+
+		std::byte* AtColumn(const Column& column, size_t row) const {
+			const Chunk& chunk = m_chunks[row / m_capacity];
+			return chunk.data + column.offset + (row % m_capacity) * column.info.size;
+		}
+
+	public:
+
+		Archetype(const ComponentMask& mask, const std::vector<ComponentInfo>& infos) : m_mask(mask) {
+			m_columnOf.fill(NO_COLUMN);
+
+			size_t bytesPerRow = sizeof(EntityID);
+			mask.ForEachSetBit([&](size_t i) {
+				SEECS_ASSERT(i < infos.size() && infos[i].size > 0, "Archetype built with unregistered component " << i);
+				m_columnOf[i] = m_columns.size();
+				m_columns.push_back({ i, 0, infos[i] });
+				bytesPerRow += infos[i].size;
+			});
+
+			// Fit as many rows as possible in one chunk, alignment padding may
+			// cost a few rows. Components bigger than a chunk get one row per chunk.
+			m_capacity = std::max<size_t>(1, CHUNK_SIZE / bytesPerRow);
+			while (m_capacity > 1 && Layout(m_capacity) > CHUNK_SIZE)
+				m_capacity--;
+
+			m_chunkBytes = std::max(CHUNK_SIZE, Layout(m_capacity));
+		}
+
+		~Archetype() {
+			while (m_size > 0)
+				RemoveRow(m_size - 1);
+
+			for (Chunk& chunk : m_chunks)
+				::operator delete(chunk.data, std::align_val_t(CHUNK_ALIGN));
+		}
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		size_t Allocate(EntityID id) {
+			// Trailing chunks may be empty but still allocated, see RemoveRow()
+			if (m_size == m_chunks.size() * m_capacity) {
+				Chunk chunk;
+				chunk.data = static_cast<std::byte*>(::operator new(m_chunkBytes, std::align_val_t(CHUNK_ALIGN)));
+				m_chunks.push_back(chunk);
+			}
+
+			Chunk& chunk = m_chunks[m_size / m_capacity];
+			chunk.Entities()[chunk.count++] = id;
+			return m_size++;
+		}
+
+		/*
+		*  Destroys the components in the given row, then moves the last row
+		*  into it. Returns the ID of the entity that moved, or NULL_ENTITY
+		*  if the removed row was the last one.
+		*/
+		EntityID RemoveRow(size_t row) {
+			SEECS_ASSERT(row < m_size, "Archetype row out of bounds: " << row);
+
+			size_t last = m_size - 1;
+			EntityID moved = NULL_ENTITY;
+
+			for (const Column& column : m_columns) {
+				column.info.destroy(AtColumn(column, row));
+				if (row != last) {
+					column.info.moveConstruct(AtColumn(column, row), AtColumn(column, last));
+					column.info.destroy(AtColumn(column, last));
+				}
+			}
+
+			if (row != last) {
+				moved = EntityAt(last);
+				m_chunks[row / m_capacity].Entities()[row % m_capacity] = moved;
+			}
+
+			m_chunks[last / m_capacity].count--;
+			m_size--;
+
+			// Keep one empty chunk around so entities bouncing in and out of
+			// an archetype don't allocate a chunk every time
+			while (m_chunks.size() >= 2 && m_chunks.back().count == 0 && m_chunks[m_chunks.size() - 2].count == 0) {
+				::operator delete(m_chunks.back().data, std::align_val_t(CHUNK_ALIGN));
+				m_chunks.pop_back();
+			}
+
+			return moved;
+		}
+
+		void* At(size_t component, size_t row) const {
+			size_t column = m_columnOf[component];
+			SEECS_ASSERT(column != NO_COLUMN, "Archetype has no column for component " << component);
+			return AtColumn(m_columns[column], row);
+		}
+
+		// Start of a component's array within a chunk
+		void* ColumnData(const Chunk& chunk, size_t component) const {
+			return chunk.data + m_columns[m_columnOf[component]].offset;
+		}
+
+		EntityID EntityAt(size_t row) const {
+			return m_chunks[row / m_capacity].Entities()[row % m_capacity];
+		}
+
+		bool Matches(const ComponentMask& include, const ComponentMask& exclude) const {
+			return m_mask.Contains(include) && !m_mask.Intersects(exclude);
+		}
+
+		Archetype*& AddEdge(size_t component) { return m_addEdges[component]; }
+		Archetype*& RemoveEdge(size_t component) { return m_removeEdges[component]; }
+
+		const ComponentMask& Mask() const { return m_mask; }
+		const std::vector<Chunk>& Chunks() const { return m_chunks; }
+		size_t ChunkCapacity() const { return m_capacity; }
+		size_t Size() const { return m_size; }
+	};
+
 	// Forward declaration for SimpleView
 	template <typename... Components>
 	class SimpleView;
 
+	// Saves and loads whole worlds, see snapshot.h
+	class WorldSnapshot;
+
 	class ECS {
 	private:
 
 		template<typename...>
 		friend class SimpleView;
 
-		// Each bit in the mask represents a component,
-		// '1' == active, '0' == inactive.
-		using ComponentMask = std::bitset<MAX_COMPONENTS>;
+		friend class WorldSnapshot;
+		friend class CommandBuffer;
+
 
+		// One handle per slot index ever created. Live slots hold the entity's
+		// handle. Free slots hold the index of the next free slot and the
+		// version the slot gets when it's reused, so the free list needs no
+		// storage of its own.
+		std::vector<EntityID> m_entitySlots;
 
-		// List of IDs already created, but no longer in use
-		std::vector<EntityID> m_availableEntities;
+		// First free slot, ENTITY_INDEX_MASK when the free list is empty
+		EntityID m_freeHead = ENTITY_INDEX_MASK;
 
 
 		// Holds the component mask for an entity
@@ -273,13 +1265,89 @@ namespace seecs {
 		std::vector<std::unique_ptr<ISparseSet>> m_componentPools;
 
 
-		// Helpful little vector that associates component index with a name
-		// Just for debugging.
-		inline static std::vector<std::string> m_componentNames;
+		// Component type IDs -> this world's component indices, plus their names
+		ComponentRegistry m_registry;
+
+
+		// Structural changes recorded while iterating in deferred mode,
+		// applied in order once the outermost deferred scope ends.
+		static constexpr size_t DELETE_ENTITY = std::numeric_limits<size_t>::max();
+
+		struct PendingChange {
+			EntityID id;
+			size_t componentIndex; // DELETE_ENTITY deletes the whole entity
+		};
+
+		std::vector<PendingChange> m_pendingChanges;
+		int m_deferDepth = 0;
+
+
+		// Change tracking, see TrackChanges()
+		uint32_t m_tick = 0;
+		ComponentMask m_trackedComponents;
+
+
+		// Scratch for the bulk entity calls: IDs returned by CreateEntities(),
+		// slots marked by DestroyEntities()
+		std::vector<EntityID> m_createdEntities;
+		std::vector<bool> m_destroyMarks;
+
+		// DestroyEntities() compacts the pools when at least 1/N of the entities go
+		static constexpr size_t BULK_DESTROY_FRACTION = 16;
+
+
+		// Archetype storage, only used in StorageMode::Archetype.
+		struct EntityLocation {
+			Archetype* archetype = nullptr;
+			size_t row = 0;
+		};
+
+		StorageMode m_storageMode = StorageMode::SparseSet;
+
+		std::vector<std::unique_ptr<Archetype>> m_archetypes;
+		std::unordered_map<ComponentMask, Archetype*, ComponentMask::Hasher> m_archetypeLookup;
+
+		// Indexed by entity slot index
+		std::vector<EntityLocation> m_entityLocations;
+
+		// Indexed by component index, filled as components are first added
+		std::vector<ComponentInfo> m_componentInfos;
 
 
-		// Highest recorded entity ID
-		EntityID m_maxEntityID = 0;
+		/*
+		*  Owning group, see Group(). The first `size` elements of every owned
+		*  pool are exactly the entities that have all the group's components,
+		*  stored in the same order in each pool.
+		*/
+		struct OwningGroup {
+			ComponentMask mask;
+			std::vector<size_t> components;
+			size_t size = 0;
+		};
+
+		// A deque so views can keep pointing at a group while more are declared
+		std::deque<OwningGroup> m_groups;
+
+
+		/*
+		*  Persistent query, see Query(). Doesn't own or reorder any pool, it
+		*  keeps its own dense list of the entities matching the masks.
+		*/
+		struct CachedQuery {
+			static constexpr uint32_t NOT_MEMBER = std::numeric_limits<uint32_t>::max();
+
+			ComponentMask include;
+			ComponentMask exclude;
+			std::vector<EntityID> entities;
+			std::vector<uint32_t> positions; // Entity slot index -> index in entities, or NOT_MEMBER
+
+			bool Has(EntityID id) const {
+				return EntityIndex(id) < positions.size() && positions[EntityIndex(id)] != NOT_MEMBER;
+			}
+		};
+
+		// A deque so views can keep pointing at a query while more are declared
+		std::deque<CachedQuery> m_queries;
 
 
 #define ENTITY_INFO(id) \
@@ -287,26 +1355,28 @@ namespace seecs {
 
 #define SEECS_ASSERT_VALID_ENTITY(id) \
 			SEECS_ASSERT(id != NULL_ENTITY, "NULL_ENTITY cannot be operated on by the ECS") \
-			SEECS_ASSERT(id < m_maxEntityID && id >= 0, "Invalid entity ID out of bounds: " << id);
+			SEECS_ASSERT(EntityIndex(id) < m_entitySlots.size(), "Invalid entity ID out of bounds: " << id);
 
 #define SEECS_ASSERT_ALIVE_ENTITY(id) \
-			SEECS_ASSERT(m_entityMasks.Get(id) != nullptr, "Attempting to access inactive entity with ID: " << id);
+			SEECS_ASSERT(IsAlive(id), "Attempting to access inactive or stale entity with ID: " << id \
+				<< " (index " << EntityIndex(id) << ", version " << EntityVersion(id) << ")");
 
 	private:
 
-		static size_t GetNextComponentIndex(std::string typeName) {
-			static size_t ind = 0;
-			m_componentNames.push_back(typeName);
-			return ind++;
-		};
+		// Index of T in this world, used to index component pools and mask bits.
+		// Types get the next free index the first time this world sees them.
+		template <typename T>
+		size_t GetComponentIndex() {
+			// Constant, so the name isn't parsed out of the signature on every call
+			static constexpr std::string_view name = TypeName<T>();
+
+			size_t index = m_registry.Find(TypeIdOf<T>);
+			if (index == ComponentRegistry::NOT_FOUND)
+				return m_registry.Insert(TypeIdOf<T>, name);
 
-		// Returns a unique ID for each type, used to index component pools
-		// - Since it's static, all ECS instances share the same index for each component type.
-        template <typename T>
-        static size_t GetComponentIndex() {
-			static size_t ind = GetNextComponentIndex(typeid(T).name());
-            return ind;
-        };
+			m_registry.CheckName(index, name);
+			return index;
+		}
 
 		// Same as GetComponentTypeIndex, but will register if the component doesn't exist yet.
 		template <typename T>
@@ -317,8 +1387,8 @@ namespace seecs {
 				RegisterComponent<T>();
 
 			// Internal error, should never happen outside development
-			SEECS_ASSERT(index < m_componentPools.size() && index >= 0,
-				"Type index out of bounds for component '" << typeid(T).name() << "'");
+			SEECS_ASSERT(index < m_componentPools.size(),
+				"Type index out of bounds for component '" << TypeName<T>() << "'");
 
 			return index;
 		}
@@ -332,6 +1402,14 @@ namespace seecs {
 			return m_componentPools[index].get();
 		}
 
+		/*
+		*   Pool pointer for a view, archetype storage has no pools so it's null
+		*/
+		template <typename T>
+		ISparseSet* GetViewPoolPtr() {
+			return IsArchetypeMode() ? nullptr : GetComponentPoolPtr<T>();
+		}
+
 		/*
 		* Retrieves reference for the specific component pool given a component name
 		*/
@@ -350,9 +1428,8 @@ namespace seecs {
 		}
 
 		template <typename Component>
-		ComponentMask::reference GetComponentBit(ComponentMask& mask) {
-			size_t bitPos = GetComponentIndex<Component>();
-			return mask[bitPos];
+		bool GetComponentBit(const ComponentMask& mask) {
+			return mask.test(GetComponentIndex<Component>());
 		}
 
 		ComponentMask& GetEntityMask(EntityID id) {
@@ -371,22 +1448,205 @@ namespace seecs {
 			return mask;
 		}
 
+		bool IsArchetypeMode() const {
+			return m_storageMode == StorageMode::Archetype;
+		}
+
+		template <typename T>
+		size_t GetOrRegisterComponentInfo() {
+			size_t index = GetComponentIndex<T>();
+			if (index >= m_componentInfos.size())
+				m_componentInfos.resize(index + 1);
+			if (m_componentInfos[index].size == 0)
+				m_componentInfos[index] = ComponentInfo::Make<T>();
+			return index;
+		}
+
+		Archetype* GetOrCreateArchetype(const ComponentMask& mask) {
+			auto it = m_archetypeLookup.find(mask);
+			if (it != m_archetypeLookup.end())
+				return it->second;
+
+			m_archetypes.push_back(std::make_unique<Archetype>(mask, m_componentInfos));
+			Archetype* archetype = m_archetypes.back().get();
+			m_archetypeLookup.emplace(mask, archetype);
+
+			SEECS_INFO("Created archetype " << mask);
+			return archetype;
+		}
+
+		/*
+		*  Moves an entity into the archetype matching its mask with one component
+		*  toggled, and returns its new row. Components shared by both archetypes
+		*  are moved over, a removed component is destroyed and an added one is
+		*  left uninitialized.
+		*/
+		size_t MigrateEntity(EntityID id, const ComponentMask& newMask, size_t toggledComponent) {
+			EntityLocation& location = m_entityLocations[EntityIndex(id)];
+			Archetype* source = location.archetype;
+
+			Archetype*& edge = newMask[toggledComponent] ?
+				source->AddEdge(toggledComponent) : source->RemoveEdge(toggledComponent);
+			if (!edge)
+				edge = GetOrCreateArchetype(newMask);
+			Archetype* target = edge;
+
+			size_t newRow = target->Allocate(id);
+			(source->Mask() & newMask).ForEachSetBit([&](size_t i) {
+				m_componentInfos[i].moveConstruct(target->At(i, newRow), source->At(i, location.row));
+			});
+
+			EntityID moved = source->RemoveRow(location.row);
+			if (moved != NULL_ENTITY)
+				m_entityLocations[EntityIndex(moved)].row = location.row;
+
+			location = { target, newRow };
+			return newRow;
+		}
+
+		// Swaps an entity into the packed front of every pool owned by the group
+		void GroupInsert(OwningGroup& group, EntityID id) {
+			for (size_t component : group.components) {
+				ISparseSet* pool = m_componentPools[component].get();
+				pool->SwapDense(pool->DenseIndexOf(id), group.size);
+			}
+			group.size++;
+		}
+
+		// Swaps an entity just past the packed front of every pool owned by the group
+		void GroupErase(OwningGroup& group, EntityID id) {
+			group.size--;
+			for (size_t component : group.components) {
+				ISparseSet* pool = m_componentPools[component].get();
+				pool->SwapDense(pool->DenseIndexOf(id), group.size);
+			}
+		}
+
+		// Call after a component was attached and the mask updated
+		void OnComponentAdded(EntityID id, const ComponentMask& mask, size_t componentIndex) {
+			for (OwningGroup& group : m_groups)
+				if (group.mask[componentIndex] && mask.Contains(group.mask))
+					GroupInsert(group, id);
+		}
+
+		// Call before a component is detached, while the mask is still intact
+		void OnComponentRemoving(EntityID id, const ComponentMask& mask, size_t componentIndex) {
+			for (OwningGroup& group : m_groups)
+				if (group.mask[componentIndex] && mask.Contains(group.mask))
+					GroupErase(group, id);
+		}
+
+		void QueryInsert(CachedQuery& query, EntityID id) {
+			if (EntityIndex(id) >= query.positions.size())
+				query.positions.resize(m_entitySlots.size(), CachedQuery::NOT_MEMBER);
+
+			query.positions[EntityIndex(id)] = (uint32_t)query.entities.size();
+			query.entities.push_back(id);
+		}
+
+		// Swap-remove, like the pools
+		void QueryErase(CachedQuery& query, EntityID id) {
+			uint32_t position = query.positions[EntityIndex(id)];
+			EntityID last = query.entities.back();
+
+			query.entities[position] = last;
+			query.positions[EntityIndex(last)] = position;
+			query.entities.pop_back();
+			query.positions[EntityIndex(id)] = CachedQuery::NOT_MEMBER;
+		}
+
+		// Call after the entity's mask changed at componentIndex
+		void OnMaskChanged(EntityID id, const ComponentMask& mask, size_t componentIndex) {
+			for (CachedQuery& query : m_queries) {
+				if (!query.include[componentIndex] && !query.exclude[componentIndex]) continue;
+
+				bool matches = mask.Matches(query.include, query.exclude);
+				if (matches != query.Has(id))
+					matches ? QueryInsert(query, id) : QueryErase(query, id);
+			}
+		}
+
+		// Refills a query from the entity masks, in mask storage order
+		void RebuildQuery(CachedQuery& query) {
+			query.entities.clear();
+			query.positions.assign(m_entitySlots.size(), CachedQuery::NOT_MEMBER);
+
+			const std::vector<EntityID>& entities = m_entityMasks.Entities();
+			for (size_t i = 0; i < entities.size(); i++)
+				if (m_entityMasks.GetAt(i)->Matches(query.include, query.exclude))
+					QueryInsert(query, entities[i]);
+		}
+
+		const CachedQuery* FindQuery(const ComponentMask& include, const ComponentMask& exclude) const {
+			for (const CachedQuery& query : m_queries)
+				if (query.include == include && query.exclude == exclude)
+					return &query;
+			return nullptr;
+		}
+
+		const OwningGroup* FindGroup(const ComponentMask& mask) const {
+			for (const OwningGroup& group : m_groups)
+				if (group.mask == mask)
+					return &group;
+			return nullptr;
+		}
+
+		/*
+		*  Type-erased removal of a component the entity is known to have
+		*/
+		void RemoveComponentAt(EntityID id, size_t componentIndex) {
+			ComponentMask& mask = GetEntityMask(id);
+
+			if (IsArchetypeMode()) {
+				mask[componentIndex] = 0;
+				MigrateEntity(id, mask, componentIndex);
+				return;
+			}
+
+			OnComponentRemoving(id, mask, componentIndex);
+			mask[componentIndex] = 0;
+			m_componentPools[componentIndex]->Delete(id);
+			OnMaskChanged(id, mask, componentIndex);
+		}
+
 	public:
 
-		ECS() = default;
+		/*
+		*  @param(mode):
+		*  * StorageMode::SparseSet stores every component type in its own pool.
+		*  * StorageMode::Archetype groups entities with identical component sets
+		*    into 16 KiB chunks, so views over several components stream over
+		*    contiguous arrays. Adding/removing components is more expensive
+		*    since the entity's other components are moved to a new archetype.
+		*/
+		explicit ECS(StorageMode mode = StorageMode::SparseSet) : m_storageMode(mode) {}
 
+		/*
+		*  Gives T its component index in this world up front, indices are
+		*  otherwise handed out in the order types are first used.
+		*/
 		template <typename T>
-		static size_t Define() {
-			static size_t index = GetNextComponentIndex(typeid(T).name());
-			return index;
+		size_t Define() {
+			return GetComponentIndex<T>();
 		}
 
 		void Reset() {
-			m_availableEntities.clear();
+			m_entitySlots.clear();
+			m_freeHead = ENTITY_INDEX_MASK;
 			m_entityMasks.Clear();
 			m_entityNames.Clear();
 			m_componentPools.clear();
-			m_maxEntityID = 0;
+			m_archetypes.clear();
+			m_archetypeLookup.clear();
+			m_entityLocations.clear();
+			m_groups.clear();
+			m_queries.clear();
+			m_tick = 0;
+			m_trackedComponents = {};
+		}
+
+		StorageMode GetStorageMode() const {
+			return m_storageMode;
 		}
 
 		/*
@@ -400,25 +1660,205 @@ namespace seecs {
 		EntityID CreateEntity(std::string name = "") {
 			EntityID id = NULL_ENTITY;
 
-			// Either spawn a new ID or recycle one
-			if (m_availableEntities.size() == 0) {
-				SEECS_ASSERT(m_maxEntityID < MAX_ENTITIES, "Entity limit exceeded");
-				id = m_maxEntityID++;
+			// Either spawn a new slot or pop one off the free list, which
+			// already carries the slot's next version
+			if (m_freeHead == ENTITY_INDEX_MASK) {
+				SEECS_ASSERT(m_entitySlots.size() < MAX_ENTITIES, "Entity limit exceeded");
+				id = MakeEntityID((EntityID)m_entitySlots.size(), 0);
+				m_entitySlots.push_back(id);
 			}
 			else {
-				id = m_availableEntities.back();
-				m_availableEntities.pop_back();
+				EntityID index = m_freeHead;
+				EntityID& slot = m_entitySlots[index];
+				m_freeHead = EntityIndex(slot);
+				id = MakeEntityID(index, EntityVersion(slot));
+				slot = id;
 			}
 
 			SEECS_ASSERT(id != NULL_ENTITY, "Cannot create entity with null ID");
 
 			m_entityMasks.Set(id, {});
 
+			if (IsArchetypeMode()) {
+				if (EntityIndex(id) >= m_entityLocations.size())
+					m_entityLocations.resize(EntityIndex(id) + 1);
+
+				Archetype* empty = GetOrCreateArchetype({});
+				m_entityLocations[EntityIndex(id)] = { empty, empty->Allocate(id) };
+			}
+
 			if (!name.empty())
 				m_entityNames.Set(id, name);
 
-			SEECS_INFO("Created entity " << ENTITY_INFO(id));
-			return id;
+			SEECS_INFO("Created entity " << ENTITY_INFO(id));
+			return id;
+		}
+
+		/*
+		*  Creates count entities that all start with a copy of the given
+		*  components and returns their IDs. Does the work of count
+		*  CreateEntity() and Add() calls in bulk: free slots are reused first
+		*  and the rest are claimed as one range, every pool grows once and the
+		*  masks are written in one pass. The entities get no name.
+		*
+		*  The span points into a buffer reused by the next call. Like Add(),
+		*  this isn't deferred, don't call it while iterating the same pools.
+		*
+		* - auto bullets = ecs.CreateEntities(1000, Transform{}, Motion{});
+		*/
+		template <typename... Components>
+		std::span<const EntityID> CreateEntities(size_t count, const Components&... components) {
+			m_createdEntities.clear();
+
+			if (IsArchetypeMode()) {
+				for (size_t i = 0; i < count; i++) {
+					EntityID id = CreateEntity();
+					(Add<Components>(id, Components(components)), ...);
+					m_createdEntities.push_back(id);
+				}
+				return m_createdEntities;
+			}
+
+			m_createdEntities.reserve(count);
+
+			// Reuse free slots first, they already carry their next version
+			while (m_freeHead != ENTITY_INDEX_MASK && m_createdEntities.size() < count) {
+				EntityID index = m_freeHead;
+				EntityID& slot = m_entitySlots[index];
+				m_freeHead = EntityIndex(slot);
+				slot = MakeEntityID(index, EntityVersion(slot));
+				m_createdEntities.push_back(slot);
+			}
+
+			const size_t first = m_entitySlots.size();
+			const size_t fresh = count - m_createdEntities.size();
+			SEECS_ASSERT(first + fresh <= MAX_ENTITIES, "Entity limit exceeded");
+
+			m_entitySlots.resize(first + fresh);
+			for (size_t i = first; i < first + fresh; i++) {
+				m_entitySlots[i] = MakeEntityID((EntityID)i, 0);
+				m_createdEntities.push_back(m_entitySlots[i]);
+			}
+
+			const std::span<const EntityID> created(m_createdEntities);
+			const ComponentMask mask = GetMask<Components...>();
+			m_entityMasks.Append(created, mask);
+
+			// Register the pools, then note which groups the new entities join. If
+			// every owned pool holds only group members, the appended entities
+			// already sit right after the packed front in the same order.
+			(GetOrRegisterComponentIndex<Components>(), ...);
+
+			std::vector<bool> packed(m_groups.size(), false);
+			for (size_t g = 0; g < m_groups.size(); g++) {
+				const OwningGroup& group = m_groups[g];
+				if (!mask.Contains(group.mask)) continue;
+
+				packed[g] = true;
+				for (size_t component : group.components)
+					packed[g] = packed[g] && m_componentPools[component]->Size() == group.size;
+			}
+
+			(GetComponentPool<Components>().Append(created, components), ...);
+
+			for (size_t g = 0; g < m_groups.size(); g++) {
+				OwningGroup& group = m_groups[g];
+				if (!mask.Contains(group.mask)) continue;
+
+				if (packed[g])
+					group.size += count;
+				else {
+					for (EntityID id : created)
+						GroupInsert(group, id);
+				}
+			}
+
+			for (CachedQuery& query : m_queries)
+				if (mask.Matches(query.include, query.exclude))
+					for (EntityID id : created)
+						QueryInsert(query, id);
+
+			SEECS_INFO("Created " << count << " entities");
+			return created;
+		}
+
+		/*
+		*  Deletes every entity in ids, like DeleteEntity() on each, and is
+		*  deferred the same way. Batches of at least 1/BULK_DESTROY_FRACTION
+		*  of the world are removed with one pass over each pool they touch
+		*  instead of a swap-remove per component, which also keeps the order
+		*  of the remaining entities. Their slots are reused in the order given.
+		*/
+		void DestroyEntities(std::span<const EntityID> ids) {
+			if (m_deferDepth > 0 || IsArchetypeMode() || ids.size() * BULK_DESTROY_FRACTION < m_entityMasks.Size()) {
+				// Reversed, so the free list hands the slots out in the given order
+				for (size_t i = ids.size(); i-- > 0;) {
+					EntityID id = ids[i];
+					DeleteEntity(id);
+				}
+				return;
+			}
+
+			m_destroyMarks.assign(m_entitySlots.size(), false);
+			std::vector<size_t> groupRemoved(m_groups.size(), 0);
+			ComponentMask touched;
+
+			for (EntityID id : ids) {
+				SEECS_ASSERT_VALID_ENTITY(id);
+				SEECS_ASSERT_ALIVE_ENTITY(id);
+				SEECS_ASSERT(!m_destroyMarks[EntityIndex(id)], "Entity " << id << " is destroyed twice");
+				m_destroyMarks[EntityIndex(id)] = true;
+
+				const ComponentMask& mask = GetEntityMask(id);
+				touched |= mask;
+				for (size_t g = 0; g < m_groups.size(); g++)
+					if (mask.Contains(m_groups[g].mask))
+						groupRemoved[g]++;
+			}
+
+			// Compaction keeps the owned pools' packed fronts aligned, only their size shrinks
+			for (size_t g = 0; g < m_groups.size(); g++)
+				m_groups[g].size -= groupRemoved[g];
+
+			touched.ForEachSetBit([&](size_t i) {
+				m_componentPools[i]->RemoveMarked(m_destroyMarks);
+			});
+
+			m_entityMasks.RemoveMarked(m_destroyMarks);
+			if (m_entityNames.Size() > 0)
+				m_entityNames.RemoveMarked(m_destroyMarks);
+
+			// Compact the queries the same way, the survivors keep their order
+			for (CachedQuery& query : m_queries) {
+				size_t kept = 0;
+				for (EntityID id : query.entities) {
+					if (m_destroyMarks[EntityIndex(id)]) {
+						query.positions[EntityIndex(id)] = CachedQuery::NOT_MEMBER;
+						continue;
+					}
+					query.positions[EntityIndex(id)] = (uint32_t)kept;
+					query.entities[kept++] = id;
+				}
+				query.entities.resize(kept);
+			}
+
+			// Reversed for the same reason as above
+			for (size_t i = ids.size(); i-- > 0;) {
+				EntityID id = ids[i];
+				m_entitySlots[EntityIndex(id)] = MakeEntityID(m_freeHead, EntityVersion(id) + 1);
+				m_freeHead = EntityIndex(id);
+			}
+
+			SEECS_INFO("Destroyed " << ids.size() << " entities");
+		}
+
+		/*
+		*  True if the handle refers to a live entity. Handles of deleted entities
+		*  stay invalid after their slot is reused, until the 8-bit version wraps.
+		*/
+		bool IsAlive(EntityID id) const {
+			EntityID index = EntityIndex(id);
+			return index < m_entitySlots.size() && m_entitySlots[index] == id;
 		}
 
 		std::string GetEntityName(EntityID id) {
@@ -441,17 +1881,43 @@ namespace seecs {
 			SEECS_ASSERT_VALID_ENTITY(id);
 			SEECS_ASSERT_ALIVE_ENTITY(id);
 
+			if (m_deferDepth > 0) {
+				m_pendingChanges.push_back({ id, DELETE_ENTITY });
+				id = NULL_ENTITY;
+				return;
+			}
+
 			std::string name = GetEntityName(id);
 			ComponentMask& mask = GetEntityMask(id);
 
 			// Destroy component associations
-			for (int i = 0; i < MAX_COMPONENTS; i++)
-				if (mask[i] == 1)
+			if (IsArchetypeMode()) {
+				EntityLocation& location = m_entityLocations[EntityIndex(id)];
+				EntityID moved = location.archetype->RemoveRow(location.row);
+				if (moved != NULL_ENTITY)
+					m_entityLocations[EntityIndex(moved)].row = location.row;
+				location = {};
+			}
+			else {
+				for (OwningGroup& group : m_groups)
+					if (mask.Contains(group.mask))
+						GroupErase(group, id);
+
+				mask.ForEachSetBit([&](size_t i) {
 					m_componentPools[i]->Delete(id);
+				});
+
+				for (CachedQuery& query : m_queries)
+					if (query.Has(id))
+						QueryErase(query, id);
+			}
 
 			m_entityMasks.Delete(id);
 			m_entityNames.Delete(id);
-			m_availableEntities.push_back(id);
+
+			// Bump the version so outstanding handles go stale, and push the slot on the free list
+			m_entitySlots[EntityIndex(id)] = MakeEntityID(m_freeHead, EntityVersion(id) + 1);
+			m_freeHead = EntityIndex(id);
 
 			SEECS_INFO("Deleted entity ['" << name << "', ID: " << id << "]");
 			id = NULL_ENTITY;
@@ -462,19 +1928,17 @@ namespace seecs {
 		*/
 		template <typename T>
 		void RegisterComponent() {
-			SEECS_ASSERT(m_componentPools.size() <= MAX_COMPONENTS,
-				"Exceeded max number of registered components");
-
+			// Asserts when a new type doesn't fit in MAX_COMPONENTS
 			size_t ind = GetComponentIndex<T>();
 			if (ind >= m_componentPools.size())
 				m_componentPools.resize(ind + 1);
 
 			SEECS_ASSERT(!m_componentPools[ind],
-				"Attempting to register component '" << typeid(T).name() << "' twice");
+				"Attempting to register component '" << TypeName<T>() << "' twice");
 
 			m_componentPools[ind] = std::make_unique<SparseSet<T>>();
 
-			SEECS_INFO("Registered component '" << typeid(T).name() << "'");
+			SEECS_INFO("Registered component '" << TypeName<T>() << "'");
 		}
 
 		/*
@@ -487,6 +1951,26 @@ namespace seecs {
 			SEECS_ASSERT_VALID_ENTITY(id);
 			SEECS_ASSERT_ALIVE_ENTITY(id);
 
+			if (IsArchetypeMode()) {
+				size_t index = GetOrRegisterComponentInfo<T>();
+				ComponentMask& mask = GetEntityMask(id);
+
+				// If component already exists, overwrite
+				if (mask[index]) {
+					EntityLocation& location = m_entityLocations[EntityIndex(id)];
+					T* existing = static_cast<T*>(location.archetype->At(index, location.row));
+					*existing = std::move(component);
+					return *existing;
+				}
+
+				mask[index] = 1;
+				size_t row = MigrateEntity(id, mask, index);
+				T* added = new (m_entityLocations[EntityIndex(id)].archetype->At(index, row)) T(std::move(component));
+
+				SEECS_INFO("Attached '" << TypeName<T>() << "' to " << ENTITY_INFO(id));
+				return *added;
+			}
+
 			SparseSet<T>& pool = GetComponentPool<T>();
 
 			// If component already exists, overwrite
@@ -496,9 +1980,14 @@ namespace seecs {
 			ComponentMask& mask = GetEntityMask(id);
 
 			SetComponentBit<T>(mask, 1);
+			pool.Set(id, std::move(component));
+			OnComponentAdded(id, mask, GetComponentIndex<T>());
+			OnMaskChanged(id, mask, GetComponentIndex<T>());
+
+			SEECS_INFO("Attached '" << TypeName<T>() << "' to " << ENTITY_INFO(id));
 
-			SEECS_INFO("Attached '" << typeid(T).name() << "' to " << ENTITY_INFO(id));
-			return *pool.Set(id, std::move(component));
+			// Group insertion may have moved the component
+			return *pool.Get(id);
 		}
 
 		/*
@@ -511,10 +2000,9 @@ namespace seecs {
 			SEECS_ASSERT_VALID_ENTITY(id);
 			SEECS_ASSERT_ALIVE_ENTITY(id);
 
-			SparseSet<T>& pool = GetComponentPool<T>();
-			T* component = pool.Get(id);
+			T* component = GetPtr<T>(id);
 			SEECS_ASSERT(component,
-				ENTITY_INFO(id) << " missing component in '" << typeid(T).name() << "' pool");
+				ENTITY_INFO(id) << " missing component in '" << TypeName<T>() << "' pool");
 
 			return *component;
 		}
@@ -529,6 +2017,14 @@ namespace seecs {
 			SEECS_ASSERT_VALID_ENTITY(id);
 			SEECS_ASSERT_ALIVE_ENTITY(id);
 
+			if (IsArchetypeMode()) {
+				size_t index = GetComponentIndex<T>();
+				if (!GetEntityMask(id)[index]) return nullptr;
+
+				EntityLocation& location = m_entityLocations[EntityIndex(id)];
+				return static_cast<T*>(location.archetype->At(index, location.row));
+			}
+
 			SparseSet<T>& pool = GetComponentPool<T>();
 			return pool.Get(id);
 		}
@@ -543,15 +2039,188 @@ namespace seecs {
 			SEECS_ASSERT_VALID_ENTITY(id);
 			SEECS_ASSERT_ALIVE_ENTITY(id);
 
-			SparseSet<T>& pool = GetComponentPool<T>();
+			if (!GetComponentBit<T>(GetEntityMask(id))) return;
+
+			if (m_deferDepth > 0) {
+				m_pendingChanges.push_back({ id, GetComponentIndex<T>() });
+				return;
+			}
 
-			if (!pool.Get(id)) return;
+			RemoveComponentAt(id, GetComponentIndex<T>());
+			SEECS_INFO("Removed '" << TypeName<T>() << "' from " << ENTITY_INFO(id));
+		}
 
-			ComponentMask& mask = GetEntityMask(id);
-			SetComponentBit<T>(mask, 0);
+		/*
+		*  Makes T's pool record when each component was added and last
+		*  changed, in ticks, for the Changed() and Added() view filters.
+		*  Sparse set storage only. Costs 8 bytes per component.
+		*
+		*  Add() stamps both ticks. Writes through views or Get() aren't
+		*  seen, since those only hand out references: make them through
+		*  Patch() or follow them with MarkChanged().
+		*/
+		template <typename T>
+		void TrackChanges() {
+			SEECS_ASSERT(!IsArchetypeMode(), "Change tracking needs StorageMode::SparseSet");
+
+			size_t index = GetOrRegisterComponentIndex<T>();
+			if (m_trackedComponents[index]) return;
+
+			m_trackedComponents[index] = 1;
+			m_componentPools[index]->TrackChanges(m_tick);
+		}
+
+		// Tick stamped on components added or changed right now
+		uint32_t GetTick() const {
+			return m_tick;
+		}
+
+		/*
+		*  Starts a new tick and returns it. A consumer keeps the value returned
+		*  right after it ran and passes it to Changed()/Added() next time, so
+		*  every change made since is seen exactly once. Several consumers can
+		*  each advance the tick.
+		*/
+		uint32_t AdvanceTick() {
+			m_tick++;
+			m_trackedComponents.ForEachSetBit([&](size_t i) {
+				m_componentPools[i]->SetTick(m_tick);
+			});
+			return m_tick;
+		}
+
+		/*
+		*  Stamps the entity's T as changed at the current tick,
+		*  no-op if T isn't tracked or the entity doesn't have one.
+		*/
+		template <typename T>
+		void MarkChanged(EntityID id) {
+			SEECS_ASSERT_VALID_ENTITY(id);
+			SEECS_ASSERT_ALIVE_ENTITY(id);
+
+			if (!IsArchetypeMode())
+				GetComponentPool<T>().MarkChanged(id);
+		}
+
+		/*
+		*  Runs func on the entity's T and marks it changed
+		*
+		* - ecs.Patch<Transform>(id, [](Transform& t) { t.position.x += 1.0f; });
+		*/
+		template <typename T, typename Func>
+		T& Patch(EntityID id, Func&& func) {
+			T& component = Get<T>(id);
+			func(component);
+			MarkChanged<T>(id);
+			return component;
+		}
+
+		/*
+		*  Declares an owning group over the given components (sparse set storage only).
+		*
+		*  The group takes ownership of the component pools and keeps them sorted so
+		*  that the first N elements of each are the N entities having all the
+		*  components, in the same order. View<Components...>() over exactly that
+		*  set then iterates with a plain index loop, no sparse lookups.
+		*  Add/Remove/DeleteEntity keep the invariant with O(1) swaps.
+		*
+		*  A pool can only be owned by one group. Declaring the same group twice
+		*  is a no-op. In archetype mode this does nothing, chunks are already packed.
+		*
+		* - ecs.Group<Transform, Motion, Boid>();
+		*/
+		template <typename... Components>
+		void Group() {
+			static_assert(sizeof...(Components) >= 2, "Groups need at least two components");
+			if (IsArchetypeMode()) return;
+
+			ComponentMask mask = GetMask<Components...>();
+			if (FindGroup(mask)) return;
+
+			OwningGroup group;
+			group.mask = mask;
+			group.components = { GetOrRegisterComponentIndex<Components>()... };
+
+			for (const OwningGroup& other : m_groups)
+				SEECS_ASSERT((other.mask & mask).none(), "Component pool is already owned by another group");
+
+			// Pack existing entities
+			ISparseSet* pool = m_componentPools[group.components[0]].get();
+			for (EntityID id : pool->GetEntityList())
+				if ((GetEntityMask(id) & mask) == mask)
+					GroupInsert(group, id);
+
+			m_groups.push_back(std::move(group));
+		}
+
+		/*
+		*  Declares a persistent query (sparse set storage only).
+		*
+		*  The query keeps a dense list of the entities that have all the given
+		*  components and none in exclude. Add/Remove/DeleteEntity update it
+		*  when an entity starts or stops matching, which costs O(1) per query
+		*  mentioning the component. View<Components...>(), with Without<...>()
+		*  matching exclude, then walks that list instead of filtering the
+		*  smallest pool. Unlike a group it doesn't reorder the pools, so
+		*  several queries can share components, and components are still
+		*  fetched with one lookup per pool.
+		*
+		*  Declaring the same query twice is a no-op. In archetype mode this does
+		*  nothing, views there already only visit matching chunks.
+		*
+		* - ecs.Query<Transform, Collider>();
+		* - ecs.Query<Transform, Motion>(ecs.MaskOf<PlayerControlled>());
+		*/
+		template <typename... Components>
+		void Query(const ComponentMask& exclude = {}) {
+			static_assert(sizeof...(Components) >= 1, "Queries need at least one component");
+			if (IsArchetypeMode()) return;
+
+			ComponentMask include = GetMask<Components...>();
+			if (FindQuery(include, exclude)) return;
 
-			pool.Delete(id);
-			SEECS_INFO("Removed '" << typeid(T).name() << "' from " << ENTITY_INFO(id));
+			(GetOrRegisterComponentIndex<Components>(), ...);
+
+			CachedQuery& query = m_queries.emplace_back();
+			query.include = include;
+			query.exclude = exclude;
+			RebuildQuery(query);
+		}
+
+		/*
+		*  Starts a deferred scope: DeleteEntity() and Remove() are recorded
+		*  instead of applied, so dense arrays stay put while they're iterated.
+		*  Scopes nest, changes are applied when the outermost one ends.
+		*
+		*  Add() is NOT deferred, attaching new components to pools that are
+		*  being iterated can still reallocate them.
+		*/
+		void BeginDeferred() {
+			m_deferDepth++;
+		}
+
+		void EndDeferred() {
+			SEECS_ASSERT(m_deferDepth > 0, "EndDeferred() called without matching BeginDeferred()");
+			if (--m_deferDepth > 0) return;
+
+			// Swap out first, so changes are applied immediately and the
+			// list can't be appended to while it's walked
+			std::vector<PendingChange> changes;
+			changes.swap(m_pendingChanges);
+
+			for (PendingChange& change : changes) {
+				// Entity may have been deleted by an earlier change
+				if (!IsAlive(change.id)) continue;
+
+				if (change.componentIndex == DELETE_ENTITY) {
+					DeleteEntity(change.id);
+					continue;
+				}
+
+				if (!GetEntityMask(change.id)[change.componentIndex]) continue;
+
+				RemoveComponentAt(change.id, change.componentIndex);
+			}
 		}
 
 		template <typename... Ts>
@@ -565,6 +2234,27 @@ namespace seecs {
 			return (Has<Ts>(id) || ...);
 		}
 
+		/*
+		*  Mask with the bits of the given component types set
+		*
+		* - ecs.MaskOf<Transform, Motion>();
+		*/
+		template <typename... Ts>
+		ComponentMask MaskOf() {
+			return GetMask<Ts...>();
+		}
+
+		/*
+		*  Creates the pools for the given components up front. Pools are otherwise
+		*  created lazily on first use, which isn't safe once views are built from
+		*  several threads at once.
+		*/
+		template <typename... Ts>
+		void RegisterPools() {
+			if (IsArchetypeMode()) return;
+			(GetOrRegisterComponentIndex<Ts>(), ...);
+		}
+
 		/*
 		*   Create a SimpleView instance which you can iterate via .ForEach()
 		* 
@@ -583,6 +2273,61 @@ namespace seecs {
 			return m_componentPools.size();
 		}
 
+		/*
+		*  Sets the dense capacity of T's pool ahead of time, use it for component
+		*  types whose population is known so spawning doesn't regrow the arrays.
+		*  Does nothing in archetype mode.
+		*/
+		template <typename T>
+		void Reserve(size_t count) {
+			if (IsArchetypeMode()) return;
+			GetComponentPoolPtr<T>()->Reserve(count);
+		}
+
+		// Releases unused pool capacity and empty sparse pages, e.g. after a mass delete
+		void ShrinkToFit() {
+			for (auto& pool : m_componentPools)
+				if (pool) pool->ShrinkToFit();
+			m_entityMasks.ShrinkToFit();
+			m_entityNames.ShrinkToFit();
+			m_entitySlots.shrink_to_fit();
+		}
+
+		struct PoolMemoryReport {
+			std::string name;
+			PoolMemoryUsage usage;
+		};
+
+		/*
+		*  Memory held by each component pool, followed by the
+		*  entity masks, names and slot table.
+		*/
+		std::vector<PoolMemoryReport> GetMemoryReport() {
+			std::vector<PoolMemoryReport> report;
+			for (size_t i = 0; i < m_componentPools.size(); i++)
+				if (m_componentPools[i])
+					report.push_back({ m_registry.GetName(i), m_componentPools[i]->GetMemoryUsage() });
+
+			report.push_back({ "(entity masks)", m_entityMasks.GetMemoryUsage() });
+			report.push_back({ "(entity names)", m_entityNames.GetMemoryUsage() });
+
+			PoolMemoryUsage slots;
+			slots.count = m_entitySlots.size();
+			slots.capacity = m_entitySlots.capacity();
+			slots.denseBytes = m_entitySlots.capacity() * sizeof(EntityID);
+			report.push_back({ "(entity slots)", slots });
+
+			return report;
+		}
+
+		// Sum of GetMemoryReport()
+		size_t GetMemoryUsage() {
+			size_t total = 0;
+			for (const PoolMemoryReport& pool : GetMemoryReport())
+				total += pool.usage.TotalBytes();
+			return total;
+		}
+
 		void PrintEntityComponents(EntityID id) {
 			SEECS_ASSERT_VALID_ENTITY(id);
 			SEECS_ASSERT_ALIVE_ENTITY(id);
@@ -590,12 +2335,10 @@ namespace seecs {
 			std::stringstream ss;
 			std::string prefix = "";
 			ss << ENTITY_INFO(id) << " components: ";
-			ComponentMask& mask = GetEntityMask(id);
-			for (int i = 0; i < MAX_COMPONENTS; i++)
-				if (mask[i] == 1) {
-					ss << prefix << m_componentNames[i];
-					prefix = ", ";
-				}
+			GetEntityMask(id).ForEachSetBit([&](size_t i) {
+				ss << prefix << m_registry.GetName(i);
+				prefix = ", ";
+			});
 			
 			SEECS_MSG(ss.str());
 		}
@@ -615,26 +2358,44 @@ namespace seecs {
 		ECS* m_ecs;
 
 		std::array<ISparseSet*, sizeof...(Components)> m_viewPools;
-		std::vector<ISparseSet*> m_excludedPools;
+
+		// Same pools as m_viewPools, statically typed for Each()
+		std::tuple<SparseSet<Components>*...> m_typedPools;
 
 		// Sparse set with the smallest number of components,
 		// basis for ForEach iterations.
 		ISparseSet* m_smallest = nullptr;
+		size_t m_smallestIndex = 0;
+		const std::vector<EntityID>* m_smallestEntities = nullptr;
+
+		// Components an entity must have and must not have. Sparse set
+		// iteration tests these against the entity's mask, archetypes
+		// against the archetype's mask.
+		ComponentMask m_includeMask;
+		ComponentMask m_excludeMask;
+
+		// Owning group over exactly these components, if one was declared
+		const ECS::OwningGroup* m_group = nullptr;
+
+		// Persistent query with the same include and exclude masks, if one was declared
+		const ECS::CachedQuery* m_query = nullptr;
+
+		// Changed() and Added() filters. The first one picks the pool to walk.
+		struct TickFilter {
+			size_t component;					// Index into Components
+			const std::vector<uint32_t>* ticks;	// Added or changed ticks of that pool
+			uint32_t since;
+		};
+
+		std::vector<TickFilter> m_tickFilters;
 
 		/*
-		*	Returns true iff all the pools in the view contain the given Entity
+		*	Returns true iff the entity has every included component and none
+		*   of the excluded ones. One mask lookup instead of one per pool.
 		*/
-		bool AllContain(EntityID id) {
-			return std::all_of(m_viewPools.begin(), m_viewPools.end(), [id](ISparseSet* pool) {
-				return pool->ContainsEntity(id);
-			});
-		}
-
-		bool NotExcluded(EntityID id) {
-			if (m_excludedPools.empty()) return true;
-			return std::none_of(m_excludedPools.begin(), m_excludedPools.end(), [id](ISparseSet* pool) {
-				return pool->ContainsEntity(id);
-			});
+		bool Matches(EntityID id) {
+			const ComponentMask* mask = m_ecs->m_entityMasks.Get(id);
+			return mask && mask->Matches(m_includeMask, m_excludeMask);
 		}
 
 		/*
@@ -652,6 +2413,218 @@ namespace seecs {
 			return std::make_tuple((std::ref(GetPoolAt<Indices>()->GetRef(id)))...);
 		}
 
+		/*
+		*  Component pointer for the pool at Index, the smallest pool is
+		*  being walked so its dense index is already known.
+		*/
+		template <size_t Index>
+		auto LookupAt(EntityID id, size_t denseIndex) {
+			auto* pool = std::get<Index>(m_typedPools);
+			return (Index == m_smallestIndex) ? pool->GetAt(denseIndex) : pool->Get(id);
+		}
+
+		template <typename>
+		static constexpr bool always_false = false;
+
+		template <typename Func>
+		static void Invoke(Func& func, EntityID id, Components&... components) {
+			if constexpr (std::is_invocable_v<Func&, EntityID, Components&...>)
+				func(id, components...);
+			else if constexpr (std::is_invocable_v<Func&, Components&...>)
+				func(components...);
+			else
+				static_assert(always_false<Func>,
+					"Bad lambda provided to .Each(), parameter pack does not match lambda args");
+		}
+
+		/*
+		*  Walks the smallest pool's dense entity list in place: no copies,
+		*  no virtual calls for included pools and the callback is inlined.
+		*/
+		template <typename Func, size_t... Indices>
+		void EachImpl(Func& func, std::index_sequence<Indices...> inds) {
+			if (m_ecs->IsArchetypeMode()) {
+				EachArchetypeImpl(func, inds);
+				return;
+			}
+
+			if (!m_tickFilters.empty()) {
+				EachFilteredRange(func, 0, m_smallestEntities->size(), inds);
+				return;
+			}
+
+			// Owning group: the first group->size elements of each pool line up
+			if (UseGroup()) {
+				EachGroupRange(func, 0, m_group->size, inds);
+				return;
+			}
+
+			if (m_query) {
+				EachQueryRange(func, 0, m_query->entities.size(), inds);
+				return;
+			}
+
+			EachSparseRange(func, 0, m_smallestEntities->size(), inds);
+		}
+
+		bool PassesTickFilters(EntityID id) {
+			for (const TickFilter& filter : m_tickFilters) {
+				size_t index = m_viewPools[filter.component]->DenseIndexOf(id);
+				if ((*filter.ticks)[index] < filter.since) return false;
+			}
+			return true;
+		}
+
+		// True if the entity passes every tick filter but the first, which is checked while walking
+		bool PassesOtherFilters(EntityID id) {
+			for (size_t f = 1; f < m_tickFilters.size(); f++) {
+				const TickFilter& filter = m_tickFilters[f];
+				size_t index = m_viewPools[filter.component]->DenseIndexOf(id);
+				if ((*filter.ticks)[index] < filter.since) return false;
+			}
+			return true;
+		}
+
+		/*
+		*  Walks [begin, end) of the first filter's pool, skipping components
+		*  stamped before its tick with a linear scan over the tick array.
+		*  Only the rest pay for looking up the other components.
+		*/
+		template <typename Func, size_t... Indices>
+		void EachFilteredRange(Func& func, size_t begin, size_t end, std::index_sequence<Indices...>) {
+			const std::vector<EntityID>& entities = *m_smallestEntities;
+			const std::vector<uint32_t>& ticks = *m_tickFilters[0].ticks;
+			const uint32_t since = m_tickFilters[0].since;
+
+			// Owning group: members are the packed front, at the same index in every pool
+			if (UseGroup()) {
+				for (size_t i = begin; i < std::min(end, m_group->size); i++) {
+					if (ticks[i] < since || !PassesOtherFilters(entities[i])) continue;
+					Invoke(func, entities[i], *std::get<Indices>(m_typedPools)->GetAt(i)...);
+				}
+				return;
+			}
+
+			for (size_t i = begin; i < end; i++) {
+				if (ticks[i] < since) continue;
+
+				// Hits are scattered, skip the mask lookup unless something is excluded
+				EntityID id = entities[i];
+				if (m_excludeMask.any() && !Matches(id)) continue;
+
+				std::tuple<Components*...> components{ LookupAt<Indices>(id, i)... };
+				if (((std::get<Indices>(components) == nullptr) || ...)) continue;
+				if (!PassesOtherFilters(id)) continue;
+
+				Invoke(func, id, *std::get<Indices>(components)...);
+			}
+		}
+
+		template <typename T, bool ADDED>
+		SimpleView& AddTickFilter(uint32_t since) {
+			constexpr size_t index = componentTypes::template index_of<T>;
+			static_assert(index < sizeof...(Components), "Changed<T>() and Added<T>() need T to be one of the view's components");
+
+			SparseSet<T>* pool = std::get<index>(m_typedPools);
+			SEECS_ASSERT(!m_ecs->IsArchetypeMode() && pool->IsTracked(),
+				"Call TrackChanges<" << TypeName<T>() << ">() before filtering views on its changes");
+
+			m_tickFilters.push_back({ index, ADDED ? &pool->AddedTicks() : &pool->ChangedTicks(), since });
+
+			// Walk the filtered pool, its tick array is what skips the unchanged components
+			if (m_tickFilters.size() == 1) {
+				m_smallest = m_viewPools[index];
+				m_smallestIndex = index;
+				m_smallestEntities = &pool->Entities();
+			}
+			return *this;
+		}
+
+		// Persistent query iteration over [begin, end) of its entity list, every one matches
+		template <typename Func, size_t... Indices>
+		void EachQueryRange(Func& func, size_t begin, size_t end, std::index_sequence<Indices...>) {
+			const std::vector<EntityID>& entities = m_query->entities;
+			for (size_t i = begin; i < end; i++) {
+				EntityID id = entities[i];
+				Invoke(func, id, *std::get<Indices>(m_typedPools)->Get(id)...);
+			}
+		}
+
+		// Sparse set iteration over [begin, end) of the smallest pool's dense list
+		template <typename Func, size_t... Indices>
+		void EachSparseRange(Func& func, size_t begin, size_t end, std::index_sequence<Indices...>) {
+			const std::vector<EntityID>& entities = *m_smallestEntities;
+
+			// Probing the one other pool is as cheap as the mask lookup
+			if (sizeof...(Components) <= 2 && m_excludeMask.none()) {
+				for (size_t i = begin; i < end; i++) {
+					EntityID id = entities[i];
+					std::tuple<Components*...> components{ LookupAt<Indices>(id, i)... };
+
+					if (((std::get<Indices>(components) == nullptr) || ...)) continue;
+					Invoke(func, id, *std::get<Indices>(components)...);
+				}
+				return;
+			}
+
+			// Filter a block of entities into a bitmap first, then visit its set
+			// bits: no mispredicted branch per rejected entity. Components added
+			// by the lambda to entities later in the same block go unnoticed.
+			for (size_t block = begin; block < end; block += 64) {
+				const size_t count = std::min<size_t>(64, end - block);
+
+				uint64_t matched = 0;
+				for (size_t j = 0; j < count; j++)
+					matched |= uint64_t(Matches(entities[block + j])) << j;
+
+				for (; matched != 0; matched &= matched - 1) {
+					const size_t i = block + std::countr_zero(matched);
+					const EntityID id = entities[i];
+					Invoke(func, id, *LookupAt<Indices>(id, i)...);
+				}
+			}
+		}
+
+		// Owning group iteration over [begin, end) of the packed range
+		template <typename Func, size_t... Indices>
+		void EachGroupRange(Func& func, size_t begin, size_t end, std::index_sequence<Indices...>) {
+			const std::vector<EntityID>& entities = std::get<0>(m_typedPools)->Entities();
+			for (size_t i = begin; i < end; i++)
+				Invoke(func, entities[i], *std::get<Indices>(m_typedPools)->GetAt(i)...);
+		}
+
+		template <typename Func, size_t... Indices>
+		void EachChunk(Func& func, const Archetype& archetype, const Archetype::Chunk& chunk, std::index_sequence<Indices...>) {
+			const size_t componentIndices[] = { m_ecs->template GetComponentIndex<Components>()... };
+			const EntityID* ids = chunk.Entities();
+			std::tuple<Components*...> columns{
+				static_cast<Components*>(archetype.ColumnData(chunk, componentIndices[Indices]))...
+			};
+
+			for (size_t row = 0; row < chunk.count; row++)
+				Invoke(func, ids[row], std::get<Indices>(columns)[row]...);
+		}
+
+		/*
+		*  Archetype version of EachImpl(): streams over every chunk of every
+		*  matching archetype, each component being a contiguous array.
+		*/
+		template <typename Func, size_t... Indices>
+		void EachArchetypeImpl(Func& func, std::index_sequence<Indices...> inds) {
+			// Indexed loop, archetypes may be created by the lambda
+			for (size_t a = 0; a < m_ecs->m_archetypes.size(); a++) {
+				const Archetype& archetype = *m_ecs->m_archetypes[a];
+				if (archetype.Size() == 0 || !archetype.Matches(m_includeMask, m_excludeMask)) continue;
+
+				for (const Archetype::Chunk& chunk : archetype.Chunks())
+					EachChunk(func, archetype, chunk, inds);
+			}
+		}
+
+		bool UseGroup() const {
+			return m_group && m_excludeMask.none();
+		}
+
 		/*
 		*  Provided the function arguments are valid, this function will iterate over the smallest pool
 		*  and run the lambda on all entities that contain all the components in the view.
@@ -663,10 +2636,28 @@ namespace seecs {
 		void ForEachImpl(Func func) {
 			constexpr auto inds = std::make_index_sequence<sizeof...(Components)>{};
 
-			// Iterate smallest component pool and compare against other pools in view
+			if (m_ecs->IsArchetypeMode()) {
+				// Collect first, same copy semantics as the sparse set path
+				std::vector<EntityID> ids;
+				auto collect = [&](EntityID id, Components&...) { ids.push_back(id); };
+				EachArchetypeImpl(collect, inds);
+
+				for (EntityID id : ids) {
+					if (!m_ecs->IsAlive(id)) continue;
+					const ComponentMask& mask = m_ecs->GetEntityMask(id);
+					if (!mask.Contains(m_includeMask) || mask.Intersects(m_excludeMask)) continue;
+					Invoke(func, id, m_ecs->Get<Components>(id)...);
+				}
+				return;
+			}
+
+			// Iterate the query's list or the smallest pool, checking each entity's mask
 			// Note this list is a COPY, allowing safe deletion during iteration.
-			for (EntityID id : m_smallest->GetEntityList()) {
-				if (AllContain(id) && NotExcluded(id)) {
+			// Masks are looked up by slot, so handles deleted by the lambda must be
+			// skipped before their slot is reused by an entity created since.
+			const std::vector<EntityID> entities = (m_query && m_tickFilters.empty()) ? m_query->entities : m_smallest->GetEntityList();
+			for (EntityID id : entities) {
+				if (m_ecs->IsAlive(id) && Matches(id) && PassesTickFilters(id)) {
 
 					// This branch is for [](EntityID id, Component& c1, Component& c2);
 					// constexpr denotes this is evaluated at compile time, which prunes
@@ -696,10 +2687,18 @@ namespace seecs {
 		using ForEachFuncWithID = std::function<void(EntityID, Components&...)>;
 
 		SimpleView(ECS* ecs) :
-			m_ecs(ecs), m_viewPools{ ecs->GetComponentPoolPtr<Components>()... }
+			m_ecs(ecs), m_viewPools{ ecs->GetViewPoolPtr<Components>()... },
+			m_typedPools{ static_cast<SparseSet<Components>*>(ecs->GetViewPoolPtr<Components>())... },
+			m_includeMask(ecs->GetMask<Components...>())
 		{
 			SEECS_ASSERT(componentTypes::size == m_viewPools.size(), "Component type list and pool array size mismatch");
 
+			// No pools to pick from, archetypes are matched by mask
+			if (ecs->IsArchetypeMode()) return;
+
+			m_group = ecs->FindGroup(m_includeMask);
+			m_query = ecs->FindQuery(m_includeMask, m_excludeMask);
+
 			auto smallestPool = std::min_element(m_viewPools.begin(), m_viewPools.end(),
 				[](ISparseSet* a, ISparseSet* b) { return a->Size() < b->Size(); }
 			);
@@ -707,14 +2706,67 @@ namespace seecs {
 			SEECS_ASSERT(smallestPool != m_viewPools.end(), "Initializing invalid/empty view");
 
 			m_smallest = *smallestPool;
+			m_smallestIndex = std::distance(m_viewPools.begin(), smallestPool);
+
+			std::apply([this](auto*... pools) {
+				size_t index = 0;
+				((index++ == m_smallestIndex ? (m_smallestEntities = &pools->Entities(), 0) : 0), ...);
+			}, m_typedPools);
+		}
+
+		/*
+		*  Upper bound on the number of entities Each() will visit, for sizing
+		*  buffers before iterating. Exact with a group or persistent query and
+		*  no tick filter, otherwise unless some entities of the walked pool
+		*  lack the view's other components, are excluded or filtered out.
+		*/
+		size_t SizeHint() const {
+			if (m_ecs->IsArchetypeMode()) {
+				size_t count = 0;
+				for (const std::unique_ptr<Archetype>& archetype : m_ecs->m_archetypes)
+					if (archetype->Matches(m_includeMask, m_excludeMask))
+						count += archetype->Size();
+				return count;
+			}
+
+			if (!m_tickFilters.empty())
+				return m_smallestEntities->size();
+
+			if (UseGroup())
+				return m_group->size;
+
+			if (m_query)
+				return m_query->entities.size();
+
+			return m_smallestEntities ? m_smallestEntities->size() : 0;
 		}
 
 		template <typename... ExcludedComponents>
 		SimpleView& Without() {
-			m_excludedPools = { m_ecs->GetComponentPoolPtr<ExcludedComponents>()... };
+			m_excludeMask = m_ecs->GetMask<ExcludedComponents...>();
+			if (!m_ecs->IsArchetypeMode())
+				m_query = m_ecs->FindQuery(m_includeMask, m_excludeMask);
 			return *this;
 		}
 
+		/*
+		*  Only visits entities whose T was changed (Changed) or added (Added)
+		*  at tick `since` or later, see ECS::AdvanceTick(). T must be one of
+		*  the view's components and tracked with ECS::TrackChanges<T>().
+		*  Iteration walks T's pool and skips old components by their tick.
+		*
+		* - ecs.View<Transform, Sprite>().Changed<Transform>(lastSeen).Each(...);
+		*/
+		template <typename T>
+		SimpleView& Changed(uint32_t since) {
+			return AddTickFilter<T, false>(since);
+		}
+
+		template <typename T>
+		SimpleView& Added(uint32_t since) {
+			return AddTickFilter<T, true>(since);
+		}
+
 		/*
 		*  Executes a passed lambda on all the entities that match the
 		*  passed parameter pack.
@@ -732,6 +2784,84 @@ namespace seecs {
 			ForEachImpl(func);
 		}
 
+		/*
+		*  Allocation-free version of ForEach(), same lambda forms.
+		*
+		*  Iterates the pools in place, so entities must NOT be deleted and
+		*  components must NOT be removed from the iterated pools inside the
+		*  lambda. Use EachDeferred() or record them into a CommandBuffer.
+		*/
+		template <typename Func>
+		void Each(Func&& func) {
+			EachImpl(func, std::make_index_sequence<sizeof...(Components)>{});
+		}
+
+		/*
+		*  Parallel version of Each(), same lambda forms.
+		*
+		*  The matching range is split into chunks of `grain` entities (whole archetype
+		*  chunks in archetype mode) that are run through
+		*  executor.ParallelFor(count, grain, [](size_t begin, size_t end) {...}).
+		*
+		*  The lambda runs concurrently: it must only write to the components it's
+		*  given and must not make structural changes. Chunking doesn't depend on the
+		*  thread count, so results are deterministic under that rule.
+		*/
+		template <typename Executor, typename Func>
+		void ParallelEach(Executor& executor, Func&& func, size_t grain = 1024) {
+			constexpr auto inds = std::make_index_sequence<sizeof...(Components)>{};
+
+			if (m_ecs->IsArchetypeMode()) {
+				std::vector<std::pair<const Archetype*, const Archetype::Chunk*>> chunks;
+				for (const std::unique_ptr<Archetype>& archetype : m_ecs->m_archetypes)
+					if (archetype->Size() > 0 && archetype->Matches(m_includeMask, m_excludeMask))
+						for (const Archetype::Chunk& chunk : archetype->Chunks())
+							chunks.push_back({ archetype.get(), &chunk });
+
+				executor.ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+					for (size_t c = begin; c < end; c++)
+						EachChunk(func, *chunks[c].first, *chunks[c].second, inds);
+				});
+				return;
+			}
+
+			if (!m_tickFilters.empty()) {
+				executor.ParallelFor(m_smallestEntities->size(), grain, [&](size_t begin, size_t end) {
+					EachFilteredRange(func, begin, end, inds);
+				});
+				return;
+			}
+
+			if (UseGroup()) {
+				executor.ParallelFor(m_group->size, grain, [&](size_t begin, size_t end) {
+					EachGroupRange(func, begin, end, inds);
+				});
+				return;
+			}
+
+			if (m_query) {
+				executor.ParallelFor(m_query->entities.size(), grain, [&](size_t begin, size_t end) {
+					EachQueryRange(func, begin, end, inds);
+				});
+				return;
+			}
+
+			executor.ParallelFor(m_smallestEntities->size(), grain, [&](size_t begin, size_t end) {
+				EachSparseRange(func, begin, end, inds);
+			});
+		}
+
+		/*
+		*  Same as Each(), but DeleteEntity() and Remove() called from the lambda
+		*  are deferred until iteration is over.
+		*/
+		template <typename Func>
+		void EachDeferred(Func&& func) {
+			m_ecs->BeginDeferred();
+			EachImpl(func, std::make_index_sequence<sizeof...(Components)>{});
+			m_ecs->EndDeferred();
+		}
+
 		/*
 		*	Holds an entity id and a tuple of references to the components returned by the view.
 		*	Access components that are part of a pack like such:
@@ -751,12 +2881,12 @@ namespace seecs {
 			}
 		*/
 		std::vector<Pack> GetPacked() {
-			constexpr auto inds = std::make_index_sequence<sizeof...(Components)>{};
 			std::vector<Pack> result;
+			result.reserve(SizeHint());
 
-			for (EntityID id : m_smallest->GetEntityList())
-				if (AllContain(id) && NotExcluded(id))
-					result.push_back({ id, MakeComponentTuple(id, inds) });
+			Each([&](EntityID id, Components&... components) {
+				result.push_back({ id, std::tuple<Components&...>(components...) });
+			});
 			return result;
 		}
 
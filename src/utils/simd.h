@@ -0,0 +1,85 @@
+#pragma once
+
+// SIMD instruction sets compiled in for this target. x86 kernels are built
+// for SSE2 (baseline on x86-64) and AVX2 (enabled per function and picked at
+// runtime), ARM kernels for AArch64 NEON (always available there).
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define SIMD_HAS_SSE 1
+        #include <emmintrin.h>
+    #endif
+
+    // MinGW GCC doesn't align the stack for 32-byte spills, AVX code can crash there
+    #if !(defined(_WIN32) && defined(__GNUC__) && !defined(__clang__))
+        #define SIMD_HAS_AVX2 1
+        #include <immintrin.h>
+    #endif
+
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define SIMD_TARGET_AVX2
+    #else
+        #define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define SIMD_HAS_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#ifndef SIMD_TARGET_AVX2
+    #define SIMD_TARGET_AVX2
+#endif
+
+/**
+ * @brief Widest instruction set the SIMD kernels can use
+ */
+enum class SimdLevel
+{
+    Scalar,
+    SSE,  // 4 lanes
+    AVX2, // 8 lanes
+    NEON  // 4 lanes
+};
+
+inline const char* GetSimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::SSE: return "SSE";
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::NEON: return "NEON";
+        default: return "Scalar";
+    }
+}
+
+/**
+ * @brief Best level supported by both the build and the CPU we're running on
+ */
+inline SimdLevel DetectSimdLevel()
+{
+#if defined(SIMD_HAS_AVX2)
+    #if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    bool avx2 = false;
+    if (info[0] >= 7)
+    {
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 6) == 6); // OSXSAVE and XMM/YMM state enabled
+        __cpuidex(info, 7, 0);
+        avx2 = osSavesYmm && (info[1] & (1 << 5));
+    }
+    #else
+    bool avx2 = __builtin_cpu_supports("avx2");
+    #endif
+    if (avx2) return SimdLevel::AVX2;
+#endif
+
+#if defined(SIMD_HAS_SSE)
+    return SimdLevel::SSE;
+#elif defined(SIMD_HAS_NEON)
+    return SimdLevel::NEON;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
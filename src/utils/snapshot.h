@@ -0,0 +1,627 @@
+#pragma once
+
+#include "seecs.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+// Load by mapping the file where there's mmap, read it into a buffer elsewhere
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(PLATFORM_WEB)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define SEECS_SNAPSHOT_MMAP 1
+#else
+    #define SEECS_SNAPSHOT_MMAP 0
+#endif
+
+namespace seecs
+{
+    /**
+     * @brief Byte stream handed to custom component writers
+     */
+    class SnapshotWriter
+    {
+    public:
+        void Write(const void* data, size_t bytes)
+        {
+            const std::byte* first = static_cast<const std::byte*>(data);
+            m_buffer.insert(m_buffer.end(), first, first + bytes);
+        }
+
+        template <typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Write the members of non-trivial types one by one");
+            Write(&value, sizeof(T));
+        }
+
+        void WriteString(const std::string& text)
+        {
+            Write((uint32_t)text.size());
+            Write(text.data(), text.size());
+        }
+
+        const std::vector<std::byte>& GetBuffer() const { return m_buffer; }
+        void Clear() { m_buffer.clear(); }
+
+    private:
+        std::vector<std::byte> m_buffer;
+    };
+
+    /**
+     * @brief Bounds-checked byte stream handed to custom component readers
+     *
+     * Reading past the end fails the stream instead of throwing, the loader
+     * checks Failed() once the block is done.
+     */
+    class SnapshotReader
+    {
+    public:
+        SnapshotReader(const std::byte* data, size_t size) : m_data(data), m_size(size) {}
+
+        bool Read(void* out, size_t bytes)
+        {
+            const std::byte* source = Take(bytes);
+            if (source && bytes > 0) std::memcpy(out, source, bytes);
+            return source != nullptr;
+        }
+
+        template <typename T>
+        bool Read(T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Read the members of non-trivial types one by one");
+            return Read(&value, sizeof(T));
+        }
+
+        bool ReadString(std::string& text)
+        {
+            uint32_t length = 0;
+            if (!Read(length)) return false;
+
+            const std::byte* source = Take(length);
+            if (!source) return false;
+            text.assign(reinterpret_cast<const char*>(source), length);
+            return true;
+        }
+
+        // Pointer to the next bytes without copying them, null if the stream is too short
+        const std::byte* Take(size_t bytes)
+        {
+            if (m_failed || (m_size - m_offset < bytes))
+            {
+                m_failed = true;
+                return nullptr;
+            }
+
+            const std::byte* source = m_data + m_offset;
+            m_offset += bytes;
+            return source;
+        }
+
+        bool Failed() const { return m_failed; }
+        size_t GetRemaining() const { return m_size - m_offset; }
+
+    private:
+        const std::byte* m_data;
+        size_t m_size;
+        size_t m_offset = 0;
+        bool m_failed = false;
+    };
+
+    /**
+     * @brief Saves and loads a whole world as one binary file
+     *
+     * The file holds the entity slot table and, per component, the pool's
+     * dense entity and component arrays as raw blocks, so loading is one bulk
+     * copy per pool instead of an Add() per component. Components are matched
+     * by the name they were registered under, not by their index in the
+     * running process, so a snapshot survives component registration order
+     * changing between builds. Entity IDs, versions and the free list are kept
+     * exactly, and so is the order of every pool.
+     *
+     * Trivially copyable components are stored raw. Anything else, like a
+     * component holding a std::string, registers a writer and a reader.
+     * Components that aren't registered can't be saved, and blocks of unknown
+     * components are skipped on load. The raw blocks are in native byte order
+     * and layout, a snapshot only loads on the platform that wrote it.
+     *
+     * Archetype storage isn't supported.
+     */
+    class WorldSnapshot
+    {
+    public:
+        static constexpr uint32_t VERSION = 1;
+
+        // FNV-1a, the stable ID a component name is stored under
+        static constexpr uint64_t HashName(std::string_view name)
+        {
+            return HashString(name);
+        }
+
+        /**
+         * @brief Store T's pool as a raw block under name
+         */
+        template <typename T>
+        void Register(const std::string& name)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Register a writer and a reader for components that aren't trivially copyable");
+
+            Entry& entry = AddEntry<T>(name, (uint32_t)sizeof(T));
+            entry.save = [](ECS& ecs, const Entry& self, std::ostream& out, SnapshotWriter&)
+            {
+                const SparseSet<T>& pool = ecs.GetComponentPool<T>();
+                const std::vector<EntityID>& entities = pool.Entities();
+                WriteBlockHeader(out, self, entities.size(), entities.size()*sizeof(T));
+                out.write(reinterpret_cast<const char*>(entities.data()), entities.size()*sizeof(EntityID));
+
+                if constexpr (requires { pool.Data().data(); })
+                {
+                    out.write(reinterpret_cast<const char*>(pool.Data().data()), pool.Data().size()*sizeof(T));
+                }
+                else
+                {
+                    for (size_t i = 0; i < pool.Data().size(); i++) out.write(reinterpret_cast<const char*>(&pool.Data()[i]), sizeof(T));
+                }
+            };
+            entry.load = [](ECS& ecs, const std::byte* entities, size_t count, SnapshotReader& payload)
+            {
+                const std::byte* components = payload.Take(count*sizeof(T));
+                if (!components) return false;
+                ecs.GetComponentPool<T>().Assign(entities, count, components);
+                return true;
+            };
+        }
+
+        /**
+         * @brief Store T's pool through write(SnapshotWriter&, const T&) and read(SnapshotReader&, T&)
+         */
+        template <typename T, typename WriteFunc, typename ReadFunc>
+        void Register(const std::string& name, WriteFunc write, ReadFunc read)
+        {
+            Entry& entry = AddEntry<T>(name, 0);
+            entry.save = [write](ECS& ecs, const Entry& self, std::ostream& out, SnapshotWriter& writer)
+            {
+                SparseSet<T>& pool = ecs.GetComponentPool<T>();
+                const std::vector<EntityID>& entities = pool.Entities();
+
+                writer.Clear();
+                for (size_t i = 0; i < entities.size(); i++) write(writer, *pool.GetAt(i));
+
+                WriteBlockHeader(out, self, entities.size(), writer.GetBuffer().size());
+                out.write(reinterpret_cast<const char*>(entities.data()), entities.size()*sizeof(EntityID));
+                out.write(reinterpret_cast<const char*>(writer.GetBuffer().data()), writer.GetBuffer().size());
+            };
+            entry.load = [read](ECS& ecs, const std::byte* entities, size_t count, SnapshotReader& payload)
+            {
+                SparseSet<T>& pool = ecs.GetComponentPool<T>();
+                pool.Assign(entities, count);
+                for (size_t i = 0; i < count; i++) read(payload, *pool.GetAt(i));
+                return !payload.Failed() && (payload.GetRemaining() == 0);
+            };
+        }
+
+        /**
+         * @brief Write every entity, its name and its registered components to path
+         * @return False if a component isn't registered or the file couldn't be written, see GetError()
+         *
+         * The file is written next to path and renamed over it when complete.
+         */
+        bool Save(ECS& ecs, const std::string& path)
+        {
+            m_error.clear();
+            if (!CheckWorld(ecs)) return false;
+
+            for (size_t i = 0; i < ecs.m_componentPools.size(); i++)
+            {
+                if (!ecs.m_componentPools[i] || (ecs.m_componentPools[i]->Size() == 0) || FindEntryByType(ecs.m_registry.GetId(i))) continue;
+                return Fail("Component '" + ecs.m_registry.GetName(i) + "' isn't registered with the snapshot");
+            }
+
+            const std::string tempPath = path + ".tmp";
+            {
+                std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+                if (!out) return Fail("Couldn't create " + tempPath);
+
+                FileHeader header;
+                std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+                header.freeHead = ecs.m_freeHead;
+                header.slotCount = ecs.m_entitySlots.size();
+                header.blockCount = 1;
+                for (const Entry& entry : m_entries) header.blockCount += HasPool(ecs, entry)? 1 : 0;
+
+                out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                out.write(reinterpret_cast<const char*>(ecs.m_entitySlots.data()), ecs.m_entitySlots.size()*sizeof(EntityID));
+
+                // Entity names, the ECS keeps them outside the component pools
+                SnapshotWriter writer;
+                const std::vector<EntityID>& named = ecs.m_entityNames.Entities();
+                for (size_t i = 0; i < named.size(); i++) writer.WriteString(*ecs.m_entityNames.GetAt(i));
+
+                Entry names;
+                names.name = ENTITY_NAMES;
+                names.stableId = HashName(ENTITY_NAMES);
+                WriteBlockHeader(out, names, named.size(), writer.GetBuffer().size());
+                out.write(reinterpret_cast<const char*>(named.data()), named.size()*sizeof(EntityID));
+                out.write(reinterpret_cast<const char*>(writer.GetBuffer().data()), writer.GetBuffer().size());
+
+                for (const Entry& entry : m_entries)
+                {
+                    if (HasPool(ecs, entry)) entry.save(ecs, entry, out, writer);
+                }
+
+                if (!out.flush()) return Fail("Couldn't write " + tempPath);
+            }
+
+            std::error_code error;
+            std::filesystem::rename(tempPath, path, error);
+            if (error) return Fail("Couldn't replace " + path + ": " + error.message());
+            return true;
+        }
+
+        /**
+         * @brief Replace every entity in ecs with the ones saved in path
+         * @return False if the file is missing, from another version or corrupt, see GetError()
+         *
+         * The file is validated before the world is touched. A file that turns
+         * out to be inconsistent halfway through, like an entity that isn't
+         * alive or has the same component twice, leaves the world empty.
+         * Pools and owning groups stay registered, groups are re-packed.
+         */
+        bool Load(ECS& ecs, const std::string& path)
+        {
+            m_error.clear();
+            if (!CheckWorld(ecs)) return false;
+
+            FileView file;
+            if (!file.Open(path)) return Fail("Couldn't read " + path);
+
+            SnapshotReader reader(file.Data(), file.Size());
+            FileHeader header;
+            if (!reader.Read(header) || (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0)) return Fail(path + " isn't a world snapshot");
+            if (header.version != VERSION) return Fail(path + " is snapshot version " + std::to_string(header.version) + ", expected " + std::to_string(VERSION));
+            if ((header.byteOrder != BYTE_ORDER_MARK) || (header.entityIdSize != sizeof(EntityID))) return Fail(path + " was written on an incompatible platform");
+            if (header.slotCount > MAX_ENTITIES) return Fail(path + " has too many entities");
+
+            const std::byte* slots = reader.Take(header.slotCount*sizeof(EntityID));
+            if (!slots) return Fail(path + " is truncated");
+
+            // Parse every block header before touching the world
+            std::vector<Block> blocks;
+            Block names;
+            for (uint64_t b = 0; b < header.blockCount; b++)
+            {
+                BlockHeader blockHeader;
+                Block block;
+                if (!reader.Read(blockHeader) || !reader.Take(blockHeader.nameLength)) return Fail(path + " is truncated");
+                if (blockHeader.count > header.slotCount) return Fail(path + " has a block with more entries than entities");
+
+                block.entities = reader.Take(blockHeader.count*sizeof(EntityID));
+                block.payload = reader.Take(blockHeader.payloadBytes);
+                block.count = blockHeader.count;
+                block.payloadBytes = blockHeader.payloadBytes;
+                if (!block.entities || !block.payload) return Fail(path + " is truncated");
+
+                if (blockHeader.stableId == HashName(ENTITY_NAMES))
+                {
+                    names = block;
+                    continue;
+                }
+
+                block.entry = FindEntryById(blockHeader.stableId);
+                if (!block.entry) continue; // Component no longer registered
+
+                if ((block.entry->elementSize != blockHeader.elementSize) || (block.entry->elementSize && (block.entry->elementSize*block.count != block.payloadBytes)))
+                {
+                    return Fail("Component '" + block.entry->name + "' changed size since " + path + " was written");
+                }
+                blocks.push_back(block);
+            }
+            ClearWorld(ecs);
+
+            ecs.m_entitySlots.resize(header.slotCount);
+            if (header.slotCount > 0) std::memcpy(ecs.m_entitySlots.data(), slots, header.slotCount*sizeof(EntityID));
+            ecs.m_freeHead = header.freeHead;
+            if (!CheckFreeList(ecs)) return Fail(path + " has a corrupt free list", ecs);
+
+            // Masks per slot, built from this world's component indices
+            std::vector<ComponentMask> masks(header.slotCount);
+            for (const Block& block : blocks)
+            {
+                const size_t component = block.entry->componentIndex(ecs);
+                for (size_t i = 0; i < block.count; i++)
+                {
+                    EntityID id;
+                    std::memcpy(&id, block.entities + i*sizeof(EntityID), sizeof(EntityID));
+                    if (!ecs.IsAlive(id) || masks[EntityIndex(id)][component]) return Fail(path + " has a corrupt '" + block.entry->name + "' block", ecs);
+                    masks[EntityIndex(id)][component] = true;
+                }
+
+                SnapshotReader payload(block.payload, block.payloadBytes);
+                if (!block.entry->load(ecs, block.entities, block.count, payload)) return Fail(path + " has a corrupt '" + block.entry->name + "' block", ecs);
+            }
+
+            // Every live entity gets a mask, also the ones without components
+            std::vector<EntityID> alive;
+            alive.reserve(header.slotCount);
+            for (size_t i = 0; i < header.slotCount; i++)
+            {
+                if (EntityIndex(ecs.m_entitySlots[i]) == i) alive.push_back(ecs.m_entitySlots[i]);
+            }
+
+            ecs.m_entityMasks.Assign(alive.data(), alive.size());
+            for (size_t i = 0; i < alive.size(); i++) *ecs.m_entityMasks.GetAt(i) = masks[EntityIndex(alive[i])];
+
+            if (names.entities)
+            {
+                std::vector<bool> named(header.slotCount, false);
+                for (size_t i = 0; i < names.count; i++)
+                {
+                    EntityID id;
+                    std::memcpy(&id, names.entities + i*sizeof(EntityID), sizeof(EntityID));
+                    if (!ecs.IsAlive(id) || named[EntityIndex(id)]) return Fail(path + " has a corrupt entity name block", ecs);
+                    named[EntityIndex(id)] = true;
+                }
+
+                SnapshotReader payload(names.payload, names.payloadBytes);
+                ecs.m_entityNames.Assign(names.entities, names.count);
+                for (size_t i = 0; i < names.count; i++) payload.ReadString(*ecs.m_entityNames.GetAt(i));
+                if (payload.Failed() || (payload.GetRemaining() != 0)) return Fail(path + " has a corrupt entity name block", ecs);
+            }
+
+            for (ECS::OwningGroup& group : ecs.m_groups) RepackGroup(ecs, group, masks);
+            for (ECS::CachedQuery& query : ecs.m_queries) ecs.RebuildQuery(query);
+
+            return true;
+        }
+
+        const std::string& GetError() const { return m_error; }
+
+    private:
+        static constexpr char MAGIC[8] = { 'S', 'E', 'E', 'C', 'S', 'N', 'A', 'P' };
+        static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304; // Reads back as 0x04030201 on the other byte order
+        static constexpr const char* ENTITY_NAMES = "seecs.EntityNames";
+
+        struct FileHeader
+        {
+            char magic[8] = {};
+            uint32_t version = VERSION;
+            uint32_t byteOrder = BYTE_ORDER_MARK;
+            uint32_t entityIdSize = sizeof(EntityID);
+            uint32_t freeHead = 0;
+            uint64_t slotCount = 0;  // EntityIDs that follow the header
+            uint64_t blockCount = 0; // Blocks that follow the slots, the entity names first
+        };
+
+        // Followed by the name, count EntityIDs and payloadBytes of components
+        struct BlockHeader
+        {
+            uint64_t stableId = 0;
+            uint32_t nameLength = 0;
+            uint32_t elementSize = 0; // sizeof the component for raw blocks, 0 for custom ones
+            uint64_t count = 0;
+            uint64_t payloadBytes = 0;
+        };
+
+        static_assert(sizeof(FileHeader) == 40 && sizeof(BlockHeader) == 32, "Snapshot headers must not have padding");
+        static_assert(sizeof(EntityID) == sizeof(uint32_t), "FileHeader stores the free head in 32 bits");
+
+        struct Entry
+        {
+            std::string name;
+            uint64_t stableId = 0;
+            ComponentTypeID typeId = 0;
+            std::function<size_t(ECS&)> componentIndex; // Index in a given world, registers T there if needed
+            uint32_t elementSize = 0;
+            std::function<void(ECS&, const Entry&, std::ostream&, SnapshotWriter&)> save;
+            std::function<bool(ECS&, const std::byte*, size_t, SnapshotReader&)> load;
+        };
+
+        // A parsed block, pointers into the loaded file
+        struct Block
+        {
+            const Entry* entry = nullptr; // Null for the entity names
+            const std::byte* entities = nullptr; // Null if the block wasn't in the file
+            const std::byte* payload = nullptr;
+            size_t count = 0;
+            size_t payloadBytes = 0;
+        };
+
+        // Read-only view of a whole file
+        class FileView
+        {
+        public:
+            FileView() = default;
+            FileView(const FileView&) = delete;
+            FileView& operator=(const FileView&) = delete;
+
+            ~FileView()
+            {
+            #if SEECS_SNAPSHOT_MMAP
+                if (m_mapping) munmap(m_mapping, m_size);
+            #endif
+            }
+
+            bool Open(const std::string& path)
+            {
+            #if SEECS_SNAPSHOT_MMAP
+                int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0) return false;
+
+                struct stat info;
+                if ((fstat(fd, &info) == 0) && (info.st_size > 0))
+                {
+                    // Fault every page in up front, the whole file is read anyway
+                    int flags = MAP_PRIVATE;
+                #ifdef MAP_POPULATE
+                    flags |= MAP_POPULATE;
+                #endif
+                    void* mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, flags, fd, 0);
+                    if (mapping != MAP_FAILED)
+                    {
+                        m_mapping = mapping;
+                        m_size = (size_t)info.st_size;
+                        madvise(m_mapping, m_size, MADV_SEQUENTIAL);
+                    }
+                }
+                close(fd);
+                if (m_mapping) return true;
+            #endif
+                std::ifstream in(path, std::ios::binary | std::ios::ate);
+                if (!in) return false;
+
+                m_buffer.resize((size_t)in.tellg());
+                in.seekg(0);
+                in.read(reinterpret_cast<char*>(m_buffer.data()), (std::streamsize)m_buffer.size());
+                m_size = m_buffer.size();
+                return (bool)in;
+            }
+
+            const std::byte* Data() const { return m_mapping ? static_cast<const std::byte*>(m_mapping) : m_buffer.data(); }
+            size_t Size() const { return m_size; }
+
+        private:
+            void* m_mapping = nullptr;
+            size_t m_size = 0;
+            std::vector<std::byte> m_buffer;
+        };
+
+        std::vector<Entry> m_entries;
+        std::string m_error;
+
+        template <typename T>
+        Entry& AddEntry(const std::string& name, uint32_t elementSize)
+        {
+            SEECS_ASSERT(!FindEntryById(HashName(name)) && (name != ENTITY_NAMES), "Snapshot component name '" << name << "' is already taken");
+            SEECS_ASSERT(!FindEntryByType(TypeIdOf<T>), "Component '" << TypeName<T>() << "' is already registered with the snapshot");
+
+            Entry& entry = m_entries.emplace_back();
+            entry.name = name;
+            entry.stableId = HashName(name);
+            entry.typeId = TypeIdOf<T>;
+            entry.componentIndex = [](ECS& ecs) { return ecs.GetComponentIndex<T>(); };
+            entry.elementSize = elementSize;
+            return entry;
+        }
+
+        const Entry* FindEntryById(uint64_t stableId) const
+        {
+            for (const Entry& entry : m_entries) if (entry.stableId == stableId) return &entry;
+            return nullptr;
+        }
+
+        const Entry* FindEntryByType(ComponentTypeID typeId) const
+        {
+            for (const Entry& entry : m_entries) if (entry.typeId == typeId) return &entry;
+            return nullptr;
+        }
+
+        static bool HasPool(const ECS& ecs, const Entry& entry)
+        {
+            const size_t componentIndex = ecs.m_registry.Find(entry.typeId);
+            return (componentIndex < ecs.m_componentPools.size()) && ecs.m_componentPools[componentIndex];
+        }
+
+        static void WriteBlockHeader(std::ostream& out, const Entry& entry, size_t count, size_t payloadBytes)
+        {
+            BlockHeader header;
+            header.stableId = entry.stableId;
+            header.nameLength = (uint32_t)entry.name.size();
+            header.elementSize = entry.elementSize;
+            header.count = count;
+            header.payloadBytes = payloadBytes;
+
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(entry.name.data(), entry.name.size());
+        }
+
+        bool CheckWorld(const ECS& ecs)
+        {
+            if (ecs.IsArchetypeMode()) return Fail("World snapshots don't support archetype storage");
+            if (ecs.m_deferDepth > 0) return Fail("World snapshots can't be taken or loaded while changes are deferred");
+            return true;
+        }
+
+        // Walks the loaded free list, every link must be a free slot and the list must end
+        static bool CheckFreeList(const ECS& ecs)
+        {
+            size_t steps = 0;
+            for (EntityID index = ecs.m_freeHead; index != ENTITY_INDEX_MASK; index = EntityIndex(ecs.m_entitySlots[index]))
+            {
+                if ((index >= ecs.m_entitySlots.size()) || (EntityIndex(ecs.m_entitySlots[index]) == index)) return false;
+                if (++steps > ecs.m_entitySlots.size()) return false;
+            }
+            return true;
+        }
+
+        // Packs the group's entities to the front of its pools. A world saved
+        // with the same group is already packed, that only needs checking.
+        static void RepackGroup(ECS& ecs, ECS::OwningGroup& group, const std::vector<ComponentMask>& masks)
+        {
+            auto matches = [&](EntityID id) { return masks[EntityIndex(id)].Contains(group.mask); };
+
+            const std::vector<EntityID>& first = ecs.m_componentPools[group.components[0]]->Entities();
+
+            size_t packed = 0;
+            while ((packed < first.size()) && matches(first[packed])) packed++;
+
+            bool isPacked = std::none_of(first.begin() + packed, first.end(), matches);
+            for (size_t c = 1; isPacked && (c < group.components.size()); c++)
+            {
+                const std::vector<EntityID>& other = ecs.m_componentPools[group.components[c]]->Entities();
+                isPacked = std::equal(first.begin(), first.begin() + packed, other.begin());
+            }
+
+            if (isPacked)
+            {
+                group.size = packed;
+                return;
+            }
+
+            // A copy, GroupInsert reorders the pool
+            for (EntityID id : ecs.m_componentPools[group.components[0]]->GetEntityList())
+            {
+                if (matches(id)) ecs.GroupInsert(group, id);
+            }
+        }
+
+        // Removes every entity but keeps the pools and owning groups registered
+        static void ClearWorld(ECS& ecs)
+        {
+            for (std::unique_ptr<ISparseSet>& pool : ecs.m_componentPools) if (pool) pool->Clear();
+            ecs.m_entityMasks.Clear();
+            ecs.m_entityNames.Clear();
+            ecs.m_entitySlots.clear();
+            ecs.m_freeHead = ENTITY_INDEX_MASK;
+            ecs.m_pendingChanges.clear();
+            for (ECS::OwningGroup& group : ecs.m_groups) group.size = 0;
+            for (ECS::CachedQuery& query : ecs.m_queries)
+            {
+                query.entities.clear();
+                query.positions.clear();
+            }
+        }
+
+        bool Fail(const std::string& error)
+        {
+            m_error = error;
+            return false;
+        }
+
+        // Fails after the world was already cleared, leaves it empty instead of half loaded
+        bool Fail(const std::string& error, ECS& ecs)
+        {
+            ClearWorld(ecs);
+            return Fail(error);
+        }
+    };
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+namespace seecs
+{
+    /**
+     * @brief Uniform spatial hash grid for fixed-radius neighbor queries
+     *
+     * Points are bucketed by the cell they fall in, cells are hashed into a
+     * power-of-two table, and the table is built with a counting sort so that
+     * every bucket is a contiguous range of a single flat index array. The grid
+     * is meant to be rebuilt every tick: buffers are kept between builds, so
+     * steady-state rebuilds do not allocate.
+     *
+     * Queries visit the 3x3 block of cells around a position, which covers every
+     * point within one cell size. Hash collisions can pull in points from far
+     * away cells, so callers must still distance-check the candidates.
+     */
+    class SpatialHashGrid
+    {
+    public:
+        /**
+         * @brief Rebuild the grid from a flat array of positions
+         * @param positions Point positions, indexed 0..count-1
+         * @param count Number of points
+         * @param cellSize Cell edge length, should be >= the largest query radius
+         */
+        void Build(const Vector2* positions, size_t count, float cellSize)
+        {
+            Build(count, [positions](size_t i) { return positions[i]; }, cellSize);
+        }
+
+        /**
+         * @brief Rebuild the grid from positions returned by positionOf(index)
+         *
+         * Lets callers with split x/y arrays build without packing them first.
+         */
+        template <typename PositionFunc>
+        void Build(size_t count, PositionFunc&& positionOf, float cellSize)
+        {
+            m_cellSize = (cellSize > 0.0f)? cellSize : 1.0f;
+            m_invCellSize = 1.0f/m_cellSize;
+
+            // Keep the load factor at or below 0.5 to limit collisions
+            size_t tableSize = 64;
+            while (tableSize < count*2) tableSize <<= 1;
+            m_tableMask = (uint32_t)(tableSize - 1);
+
+            m_cellStart.assign(tableSize + 1, 0);
+            m_pointBucket.resize(count);
+            m_entries.resize(count);
+
+            // Count points per bucket
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t bucket = BucketOf(positionOf(i));
+                m_pointBucket[i] = bucket;
+                m_cellStart[bucket + 1]++;
+            }
+
+            // Prefix sum gives the first entry of every bucket
+            for (size_t b = 0; b < tableSize; b++) m_cellStart[b + 1] += m_cellStart[b];
+
+            // Scatter point indices into their bucket ranges, m_cursor is a
+            // scratch copy of the bucket starts so m_cellStart stays intact
+            m_cursor.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+            for (size_t i = 0; i < count; i++) m_entries[m_cursor[m_pointBucket[i]]++] = (uint32_t)i;
+        }
+
+        /**
+         * @brief Entry ranges of the distinct buckets in the 3x3 cells around position
+         * @param begins Receives the first entry of every range, room for 9
+         * @param ends Receives the end of every range, room for 9
+         * @return Number of ranges written
+         *
+         * Ranges index GetEntries(). Buckets shared by several cells through a
+         * hash collision are only reported once.
+         */
+        int GetNearRanges(Vector2 position, uint32_t* begins, uint32_t* ends) const
+        {
+            if (m_entries.empty()) return 0;
+
+            int32_t cellX = CellCoord(position.x);
+            int32_t cellY = CellCoord(position.y);
+
+            uint32_t visited[9] = { 0 };
+            int visitedCount = 0;
+            int rangeCount = 0;
+
+            for (int32_t dy = -1; dy <= 1; dy++)
+            {
+                for (int32_t dx = -1; dx <= 1; dx++)
+                {
+                    uint32_t bucket = Hash(cellX + dx, cellY + dy);
+
+                    bool seen = false;
+                    for (int v = 0; v < visitedCount; v++)
+                    {
+                        if (visited[v] == bucket) { seen = true; break; }
+                    }
+                    if (seen) continue;
+                    visited[visitedCount++] = bucket;
+
+                    if (m_cellStart[bucket] == m_cellStart[bucket + 1]) continue;
+                    begins[rangeCount] = m_cellStart[bucket];
+                    ends[rangeCount] = m_cellStart[bucket + 1];
+                    rangeCount++;
+                }
+            }
+
+            return rangeCount;
+        }
+
+        /**
+         * @brief Invoke func(index) for every point in the 3x3 cells around position
+         *
+         * Each candidate is reported once, even if several of the 9 cells share
+         * a bucket through a hash collision.
+         */
+        template <typename Func>
+        void ForEachNear(Vector2 position, Func&& func) const
+        {
+            uint32_t begins[9], ends[9];
+            int rangeCount = GetNearRanges(position, begins, ends);
+
+            for (int r = 0; r < rangeCount; r++)
+            {
+                for (uint32_t e = begins[r]; e < ends[r]; e++) func(m_entries[e]);
+            }
+        }
+
+        /**
+         * @brief Invoke func(index) for every point in the cells overlapping rect
+         *
+         * Each candidate is reported once, buckets reached from several cells are
+         * only visited the first time. Hash collisions pull in points from outside
+         * the rect, so callers must still test the candidates. A rect covering at
+         * least as many cells as the table has buckets reports every point.
+         *
+         * Not const, the visited buckets are tracked in a scratch bitmap kept by
+         * the grid, so only one query can run at a time.
+         */
+        template <typename Func>
+        void ForEachInRect(Rectangle rect, Func&& func)
+        {
+            if (m_entries.empty()) return;
+
+            const size_t tableSize = (size_t)m_tableMask + 1;
+            const float firstX = floorf(rect.x*m_invCellSize);
+            const float firstY = floorf(rect.y*m_invCellSize);
+            const float cellsX = floorf((rect.x + rect.width)*m_invCellSize) - firstX + 1.0f;
+            const float cellsY = floorf((rect.y + rect.height)*m_invCellSize) - firstY + 1.0f;
+            if ((cellsX <= 0.0f) || (cellsY <= 0.0f)) return;
+
+            // Checked in float first, a huge rect would overflow the cell coordinates
+            if (cellsX*cellsY >= (float)tableSize)
+            {
+                for (uint32_t index : m_entries) func(index);
+                return;
+            }
+
+            m_visited.assign((tableSize + 63)/64, 0);
+            for (int32_t cellY = (int32_t)firstY; cellY < (int32_t)(firstY + cellsY); cellY++)
+            {
+                for (int32_t cellX = (int32_t)firstX; cellX < (int32_t)(firstX + cellsX); cellX++)
+                {
+                    uint32_t bucket = Hash(cellX, cellY);
+                    uint64_t bit = 1ull << (bucket & 63);
+                    if (m_visited[bucket >> 6] & bit) continue;
+                    m_visited[bucket >> 6] |= bit;
+
+                    for (uint32_t e = m_cellStart[bucket]; e < m_cellStart[bucket + 1]; e++) func(m_entries[e]);
+                }
+            }
+        }
+
+        /**
+         * @brief Point indices grouped by bucket, in the order queries visit them
+         */
+        const std::vector<uint32_t>& GetEntries() const { return m_entries; }
+
+        float GetCellSize() const { return m_cellSize; }
+        size_t GetPointCount() const { return m_entries.size(); }
+
+    private:
+        float m_cellSize = 1.0f;
+        float m_invCellSize = 1.0f;
+        uint32_t m_tableMask = 0;
+
+        std::vector<uint32_t> m_cellStart;    // tableSize + 1 prefix offsets into m_entries
+        std::vector<uint32_t> m_entries;      // Point indices grouped by bucket
+        std::vector<uint32_t> m_pointBucket;  // Bucket of every point, scratch for the build
+        std::vector<uint32_t> m_cursor;       // Write cursor per bucket, scratch for the build
+        std::vector<uint64_t> m_visited;      // One bit per bucket, scratch for rect queries
+
+        int32_t CellCoord(float value) const
+        {
+            return (int32_t)floorf(value*m_invCellSize);
+        }
+
+        uint32_t Hash(int32_t cellX, int32_t cellY) const
+        {
+            uint32_t h = ((uint32_t)cellX*73856093u) ^ ((uint32_t)cellY*19349663u);
+            return h & m_tableMask;
+        }
+
+        uint32_t BucketOf(Vector2 position) const
+        {
+            return Hash(CellCoord(position.x), CellCoord(position.y));
+        }
+    };
+}